@@ -113,11 +113,13 @@ int main(int argc, char *argv[])
     for ( int i = 1; i<=numSteps; ++i) // for all timesteps
     {
         // Compute the system for the timestep i (rhs is assumed constant wrt time)
-        assembler.nextTimeStep(Sol, Dt);
+        // The matrix changes only if the time step size changes
+        if ( assembler.nextTimeStep(Sol, Dt) )
+            solver.compute( assembler.matrix() );
         gsInfo<<"Solving timestep "<< i*Dt<<".\n";
 
         // Solve for current timestep, overwrite previous solution
-        Sol = solver.compute( assembler.matrix() ).solve( assembler.rhs() );
+        Sol = solver.solve( assembler.rhs() );
 
         // Obtain current solution as an isogeometric field
         //sol = assembler.constructSolution(Sol); // same as next line
@@ -37,6 +37,7 @@ int main(int argc, char *argv[])
     real_t tolerance = 1.e-8;
     index_t maxIterations = 100;
     bool calcEigenvalues = false;
+    index_t denseSchur = 0;
     std::string out;
     bool plot = false;
 
@@ -52,6 +53,7 @@ int main(int argc, char *argv[])
     cmd.addReal  ("t", "Solver.Tolerance",      "Stopping criterion for linear solver", tolerance);
     cmd.addInt   ("",  "Solver.MaxIterations",  "Maximum iterations for linear solver", maxIterations);
     cmd.addSwitch("",  "Solver.CalcEigenvalues","Estimate eigenvalues based on Lanczos", calcEigenvalues);
+    cmd.addInt   ("",  "DenseSchur",            "Assemble the local Schur complements with at most that many skeleton dofs as dense matrices", denseSchur);
     cmd.addString("",  "out",                   "Write solution and used options to file", out);
     cmd.addSwitch(     "plot",                  "Plot the result with Paraview", plot);
 
@@ -366,6 +368,10 @@ int main(int argc, char *argv[])
     prec.setupMultiplicityScaling();
     //! [Setup scaling]
 
+    // For small skeletons, dense local Schur complements are cheaper to apply
+    if (denseSchur > 0)
+        prec.setupDenseSchurComplements(denseSchur);
+
     gsInfo << "done.\n    Setup rhs... " << std::flush;
     // Compute the Schur-complement contribution for the right-hand-side
     //! [Setup rhs]
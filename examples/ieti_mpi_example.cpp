@@ -0,0 +1,456 @@
+/** @file ieti_mpi_example.cpp
+
+    @brief Provides an example for the ieti solver where the patches are
+    distributed over the MPI ranks.
+
+    Here, CG solves the Schur complement formulation, see also
+    ieti_example.cpp for the shared-memory variant.
+
+    Execute (eg. with 4 processes):
+       mpirun -np 4 ./bin/ieti_mpi_example --SplitPatches 2
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#include <ctime>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    /************** Define command line options *************/
+
+    std::string geometry("domain2d/yeti_mp2.xml");
+    index_t splitPatches = 1;
+    index_t refinements = 1;
+    index_t degree = 2;
+    std::string boundaryConditions("d");
+    std::string primals("c");
+    bool eliminateCorners = false;
+    real_t tolerance = 1.e-8;
+    index_t maxIterations = 100;
+    std::string out;
+    bool plot = false;
+
+    gsCmdLine cmd("Solves a PDE with an isogeometric discretization using an isogeometric tearing and interconnecting (IETI) solver, "
+        "where the patches are distributed over the MPI ranks.");
+    cmd.addString("g", "Geometry",              "Geometry file", geometry);
+    cmd.addInt   ("",  "SplitPatches",          "Split every patch that many times in 2^d patches", splitPatches);
+    cmd.addInt   ("r", "Refinements",           "Number of uniform h-refinement steps to perform before solving", refinements);
+    cmd.addInt   ("p", "Degree",                "Degree of the B-spline discretization space", degree);
+    cmd.addString("b", "BoundaryConditions",    "Boundary conditions", boundaryConditions);
+    cmd.addString("c", "Primals",               "Primal constraints (c=corners, e=edges, f=faces)", primals);
+    cmd.addSwitch("e", "EliminateCorners",      "Eliminate corners (if they are primals)", eliminateCorners);
+    cmd.addReal  ("t", "Solver.Tolerance",      "Stopping criterion for linear solver", tolerance);
+    cmd.addInt   ("",  "Solver.MaxIterations",  "Maximum iterations for linear solver", maxIterations);
+    cmd.addString("",  "out",                   "Write solution and used options to file", out);
+    cmd.addSwitch(     "plot",                  "Plot the result with Paraview", plot);
+
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+    // Initialize the MPI environment and obtain the world communicator
+    const gsMpi & mpi = gsMpi::init(argc, argv);
+    gsMpiComm comm = mpi.worldComm();
+    const int rank = comm.rank(), nRanks = comm.size();
+
+    // Only the first rank writes to the terminal; a stream without buffer
+    // discards its output
+    std::ostream info( rank == 0 ? gsInfo.rdbuf() : NULL );
+
+    if ( ! gsFileManager::fileExists(geometry) )
+    {
+        info << "Geometry file could not be found.\n";
+        info << "I was searching in the current directory and in: " << gsFileManager::getSearchPaths() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    info << "Run ieti_mpi_example on " << nRanks << " ranks with options:\n" << cmd << std::endl;
+
+    /******************* Define geometry ********************/
+
+    info << "Define geometry... " << std::flush;
+
+    gsMultiPatch<>::uPtr mpPtr = gsReadFile<>(geometry);
+    if (!mpPtr)
+    {
+        info << "No geometry found in file " << geometry << ".\n";
+        return EXIT_FAILURE;
+    }
+    gsMultiPatch<>& mp = *mpPtr;
+
+    for (index_t i=0; i<splitPatches; ++i)
+    {
+        info << "split patches uniformly... " << std::flush;
+        mp = mp.uniformSplit();
+    }
+
+    info << "done.\n";
+
+    /************** Define boundary conditions **************/
+
+    info << "Define right-hand-side and boundary conditions... " << std::flush;
+
+    // Right-hand-side
+    gsFunctionExpr<> f( "2*sin(x)*cos(y)", mp.geoDim() );
+
+    // Dirichlet function
+    gsFunctionExpr<> gD( "sin(x)*cos(y)", mp.geoDim() );
+
+    // Neumann
+    gsConstantFunction<> gN( 1.0, mp.geoDim() );
+
+    gsBoundaryConditions<> bc;
+    {
+        const index_t len = boundaryConditions.length();
+        index_t i = 0;
+        for (gsMultiPatch<>::const_biterator it = mp.bBegin(); it < mp.bEnd(); ++it)
+        {
+            char b_local;
+            if ( len == 1 )
+                b_local = boundaryConditions[0];
+            else if ( i < len )
+                b_local = boundaryConditions[i];
+            else
+            {
+                info << "\nNot enough boundary conditions given.\n";
+                return EXIT_FAILURE;
+            }
+
+            if ( b_local == 'd' )
+                bc.addCondition( *it, condition_type::dirichlet, &gD );
+            else if ( b_local == 'n' )
+                bc.addCondition( *it, condition_type::neumann, &gN );
+            else
+            {
+                info << "\nInvalid boundary condition given; only 'd' (Dirichlet) and 'n' (Neumann) are supported.\n";
+                return EXIT_FAILURE;
+            }
+
+            ++i;
+        }
+        if ( len > i )
+            info << "\nToo many boundary conditions have been specified. Ignoring the remaining ones.\n";
+        info << "done. "<<i<<" boundary conditions set.\n";
+    }
+
+    /************ Select the patches of this rank **********/
+
+    info << "Select the patches of this rank... " << std::flush;
+
+    const index_t nPatches = mp.nPatches();
+
+    // Every rank owns a contiguous range of patches
+    std::vector<index_t> ownedPatches;
+    for (index_t k=(nPatches * rank) / nRanks; k<(nPatches * (rank+1)) / nRanks; ++k)
+        ownedPatches.push_back(k);
+
+    // Every rank sets up the discretization only for its patches and their
+    // neighbours; these are all patches that share dofs or Lagrange
+    // multipliers with the patches of this rank
+    //! [Restrict to patches]
+    std::vector<index_t> patches = gsDistributedIetiSystem<>::neighborhood(mp, ownedPatches);
+    gsMultiPatch<> mpPart;
+    gsBoundaryConditions<> bcPart;
+    if (!patches.empty()) // there might be more ranks than patches
+        gsDistributedIetiSystem<>::restrictToPatches(mp, bc, patches, mpPart, bcPart);
+    //! [Restrict to patches]
+
+    // The owners of the patches of the part
+    std::vector<int> ranks(patches.size());
+    for (size_t k=0; k<patches.size(); ++k)
+        for (ranks[k]=0; (nPatches * (ranks[k]+1)) / nRanks <= patches[k]; ++ranks[k]) {}
+
+    info << "done. The first rank holds " << patches.size() << " of " << nPatches << " patches.\n";
+
+    /************ Setup bases and adjust degree *************/
+
+    gsMultiBasis<> mb;
+    if (!patches.empty())
+        mb = gsMultiBasis<>(mpPart);
+
+    info << "Setup bases and adjust degree... " << std::flush;
+
+    for ( size_t i = 0; i < mb.nBases(); ++ i )
+        mb[i].setDegreePreservingMultiplicity(degree);
+
+    for ( index_t i = 0; i < refinements; ++i )
+        mb.uniformRefine();
+
+    info << "done.\n";
+
+    /********* Setup assembler and assemble matrix **********/
+
+    info << "Setup assembler and assemble matrix... " << std::flush;
+
+    // The ieti mapper holds the dof mappers, the primal constraints and the
+    // (sparse) jump matrices for the patches of the part
+    gsIetiMapper<> ietiMapper;
+    if (!patches.empty())
+    {
+        typedef gsExprAssembler<>::space  space;
+        gsExprAssembler<> assembler;
+        space u = assembler.getSpace(mb);
+        bcPart.setGeoMap(mpPart);
+        u.setup(bcPart, dirichlet::interpolation, 0);
+        ietiMapper.init( mb, u.mapper(), u.fixedPart() );
+    }
+
+    // Which primal dofs should we choose?
+    bool cornersAsPrimals = false, edgesAsPrimals = false, facesAsPrimals = false;
+    for (size_t i=0; i<primals.length(); ++i)
+        switch (primals[i])
+        {
+            case 'c': cornersAsPrimals = true;   break;
+            case 'e': edgesAsPrimals = true;     break;
+            case 'f': facesAsPrimals = true;     break;
+            default:
+                info << "\nUnkown type of primal constraint: \"" << primals[i] << "\"\n";
+                return EXIT_FAILURE;
+        }
+
+    if (!patches.empty())
+    {
+        if (cornersAsPrimals)
+            ietiMapper.cornersAsPrimals();
+
+        if (edgesAsPrimals)
+            ietiMapper.interfaceAveragesAsPrimals(mpPart,1);
+
+        if (facesAsPrimals)
+            ietiMapper.interfaceAveragesAsPrimals(mpPart,2);
+
+        // Compute the jump matrices
+        bool fullyRedundant = true,
+             noLagrangeMultipliersForCorners = cornersAsPrimals;
+        ietiMapper.computeJumpMatrices(fullyRedundant, noLagrangeMultipliersForCorners);
+    }
+
+    //! [Setup communication]
+    // The distributed ieti system numbers the Lagrange multipliers touched by
+    // the patches of this rank and the primal dofs consistently over all ranks
+    gsDistributedIetiSystem<> ieti(comm);
+    ieti.setupCommunication(ietiMapper, patches, ranks);
+    //! [Setup communication]
+
+    // The preconditioner and the primal system only see the patches of this
+    // rank and the Lagrange multipliers in local numbering
+    gsScaledDirichletPrec<> prec;
+    prec.reserve(ownedPatches.size());
+
+    gsPrimalSystem<> primal(ieti.nPrimalDofs());
+    if (eliminateCorners)
+        primal.setEliminatePointwiseConstraints(true);
+
+    for (size_t k=0; k<patches.size(); ++k)
+    {
+        if (ranks[k] != rank) continue;
+
+        // We use the local variants of everything
+        gsBoundaryConditions<> bc_local;
+        bcPart.getConditionsForPatch(k,bc_local);
+        gsMultiPatch<> mp_local = mpPart[k];
+        gsMultiBasis<> mb_local = mb[k];
+
+        // The usual stuff for the expression assembler
+        typedef gsExprAssembler<>::geometryMap geometryMap;
+        typedef gsExprAssembler<>::variable    variable;
+        typedef gsExprAssembler<>::space       space;
+
+        // We set up the assembler
+        gsExprAssembler<> assembler(1,1);
+
+        // Elements used for numerical integration
+        assembler.setIntegrationElements(mb_local);
+
+        // Set the geometry map
+        geometryMap G = assembler.getMap(mp_local);
+
+        // Set the discretization space
+        space u = assembler.getSpace(mb_local);
+
+        // Incorporate Dirichlet BC
+        bc_local.setGeoMap(mp_local);
+        u.setup(bc_local, dirichlet::interpolation, 0);
+        ietiMapper.initFeSpace(u,k);
+
+        // Set the source term
+        auto ff = assembler.getCoeff(f, G);
+
+        // Compute the system matrix and right-hand side
+        assembler.initSystem();
+        assembler.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G), u * ff * meas(G) );
+
+        // Add contributions from Neumann conditions to right-hand side
+        variable g_N = assembler.getBdrFunction();
+        assembler.assembleBdr(bc_local.get("Neumann"),  u * g_N.val() * nv(G).norm() );
+
+        // Fetch data; the jump matrix acts on the Lagrange multipliers of
+        // this rank in local numbering
+        gsSparseMatrix<real_t, RowMajor> jumpMatrix  = ieti.jumpMatrix(k);
+        gsSparseMatrix<>                 localMatrix = assembler.matrix();
+        gsMatrix<>                       localRhs    = assembler.rhs();
+
+        prec.addSubdomain(
+            gsScaledDirichletPrec<>::restrictToSkeleton(
+                jumpMatrix,
+                localMatrix,
+                ietiMapper.skeletonDofs(k)
+            )
+        );
+
+        primal.handleConstraints(
+            ietiMapper.primalConstraints(k),
+            ieti.primalDofIndices(k),
+            jumpMatrix,
+            localMatrix,
+            localRhs
+        );
+
+        ieti.addSubdomain(
+            jumpMatrix.moveToPtr(),
+            makeMatrixOp(localMatrix.moveToPtr()),
+            give(localRhs)
+        );
+    }
+
+    // The contributions to the primal problem are gathered on all ranks,
+    // which solve it redundantly
+    //! [Primal to system]
+    if (ieti.nPrimalDofs()>0)
+        ieti.addPrimalSubdomain( primal.jumpMatrix(), primal.localMatrix(), primal.localRhs() );
+    //! [Primal to system]
+
+    info << "done. " << ieti.nPrimalDofs() << " primal dofs, "
+         << ieti.nLagrangeMultipliers() << " Lagrange multipliers.\n";
+
+    /**************** Setup solver and solve ****************/
+
+    info << "Setup solver and solve... \n"
+        "    Setup multiplicity scaling... " << std::flush;
+
+    gsLinearOperator<>::Ptr precOp;
+    if (!ownedPatches.empty())
+    {
+        prec.setupMultiplicityScaling();
+        precOp = prec.preconditioner();
+    }
+
+    info << "done.\n    Setup rhs... " << std::flush;
+    gsMatrix<> rhsForSchur = ieti.rhsForSchurComplement();
+
+    info << "done.\n    Solve for Lagrange multipliers... " << std::flush;
+    // The initial guess has to be consistent on all ranks
+    gsMatrix<> lambda;
+    lambda.setZero( ieti.nLocalLagrangeMultipliers(), 1 );
+
+    gsMatrix<> errorHistory;
+    //! [Solve]
+    const bool success = ieti.solve( ieti.distributedOp(precOp), rhsForSchur, lambda, errorHistory,
+        tolerance, maxIterations );
+    //! [Solve]
+
+    info << "done.\n    Reconstruct solution from Lagrange multipliers... " << std::flush;
+    std::vector< gsMatrix<> > localSolutions = primal.distributePrimalSolution(
+        ieti.constructSolutionFromLagrangeMultipliers(lambda)
+    );
+
+    // Gather the patch-local solutions on the first rank
+    int count = 0;
+    for (size_t k=0; k<localSolutions.size(); ++k)
+        count += localSolutions[k].rows();
+    std::vector<int> counts(nRanks), displ(nRanks+1, 0);
+    comm.allgather(&count, 1, counts.data());
+    for (int q=0; q<nRanks; ++q)
+        displ[q+1] = displ[q] + counts[q];
+    gsMatrix<> send(count, 1), all(displ[nRanks], 1);
+    for (size_t k=0, i=0; k<localSolutions.size(); ++k)
+    {
+        send.middleRows(i, localSolutions[k].rows()) = localSolutions[k];
+        i += localSolutions[k].rows();
+    }
+    comm.gatherv(send.data(), count, all.data(), counts.data(), displ.data(), 0);
+    info << "done.\n\n";
+
+    /******************** Print end Exit ********************/
+
+    const index_t iter = errorHistory.rows()-1;
+    if (success)
+        info << "Reached desired tolerance after " << iter << " iterations:\n";
+    else
+        info << "Did not reach desired tolerance after " << iter << " iterations:\n";
+
+    if (errorHistory.rows() < 20)
+        info << errorHistory.transpose() << "\n\n";
+    else
+        info << errorHistory.topRows(5).transpose() << " ... " << errorHistory.bottomRows(5).transpose()  << "\n\n";
+
+    if (rank == 0 && (!out.empty() || plot))
+    {
+        // Only for the output, the first rank sets up the discretization for
+        // the whole domain
+        gsMultiBasis<> mbGlobal(mp);
+        for ( size_t i = 0; i < mbGlobal.nBases(); ++ i )
+            mbGlobal[i].setDegreePreservingMultiplicity(degree);
+        for ( index_t i = 0; i < refinements; ++i )
+            mbGlobal.uniformRefine();
+
+        gsIetiMapper<> globalMapper;
+        {
+            gsExprAssembler<> assembler;
+            gsExprAssembler<>::space u = assembler.getSpace(mbGlobal);
+            bc.setGeoMap(mp);
+            u.setup(bc, dirichlet::interpolation, 0);
+            globalMapper.init( mbGlobal, u.mapper(), u.fixedPart() );
+        }
+
+        std::vector< gsMatrix<> > patchSolutions(nPatches);
+        for (index_t k=0, i=0; k<nPatches; ++k)
+        {
+            const index_t sz = globalMapper.dofMapperLocal(k).freeSize();
+            patchSolutions[k] = all.middleRows(i, sz);
+            i += sz;
+        }
+        gsMatrix<> uVec = globalMapper.constructGlobalSolutionFromLocalSolutions(patchSolutions);
+
+        if (!out.empty())
+        {
+            gsFileData<> fd;
+            std::time_t time = std::time(NULL);
+            fd.add(cmd);
+            fd.add(uVec);
+            fd.addComment(std::string("ieti_mpi_example   Timestamp:")+std::ctime(&time));
+            fd.save(out);
+            gsInfo << "Write solution to file " << out << "\n";
+        }
+
+        if (plot)
+        {
+            gsInfo << "Write Paraview data to file ieti_result.pvd\n";
+            gsExprAssembler<> A(1,1);
+            typedef gsExprAssembler<>::geometryMap geometryMap;
+            typedef gsExprAssembler<>::space       space;
+            typedef gsExprAssembler<>::solution    solution;
+            A.setIntegrationElements(mbGlobal);
+            gsExprEvaluator<> ev(A);
+            geometryMap G = A.getMap(mp);
+            space u = A.getSpace(mbGlobal);
+            solution u_sol = A.getSolution(u, uVec);
+            u.setup(bc, dirichlet::interpolation, 0);
+            ev.options().setSwitch( "plot.elements", true );
+            ev.writeParaview( u_sol, G, "ieti_result" );
+        }
+    }
+    if (!plot&&out.empty())
+    {
+        info << "Done. No output created, re-run with --plot to get a ParaView "
+                "file containing the solution or --out to write solution to xml file.\n";
+    }
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -89,7 +89,7 @@ int main(int argc, char* argv[])
     cmd.addInt("G", "CoarseOperator", "Derive coarse stiffness matrix (1) by rediscretization or (2) using Galerkin projection if possible", typeCoarseOperator);
     cmd.addInt("m", "Cycle_p", "Type of cycle where p or z-coarsening is applied: (1) V-cycle or (2) W-cycle", typeCycle_p);
     cmd.addInt("M", "Cycle_h", "Type of cycle where h-coarsening is applied: (1) V-cycle or (2) W-cycle", typeCycle_h);
-    cmd.addInt("S", "Smoother", "Smoother: (1) ILUT, (2) Gauss-Seidel, (3) subspace corrected mass smoother or (4) Block ILUT", typeSmoother);
+    cmd.addInt("S", "Smoother", "Smoother: (1) ILUT, (2) Gauss-Seidel, (3) subspace corrected mass smoother, (4) Block ILUT or (5) Chebyshev", typeSmoother);
     cmd.addInt("v", "Smoothing", "Number of pre and post smoothing steps", numSmoothing);
     cmd.addReal("", "DampingSCMS", "Damping for subspace corrected mass smoother (otherwise ignored)", dampingSCMS);
     cmd.addInt("s", "Solver", "Solver: (1) mg as stand-alone solver, (2) BiCGStab prec. with mg or (3) CG prec. with mg", typeSolver);
@@ -538,6 +538,10 @@ int main(int argc, char* argv[])
                 mg->setSmoother(i,setupBlockILUT(matrices[i], bases[i], bcInfo, opt));
                 gsInfo << "Smoother for level " << i << ": Blockwise Incomplete LU\n";
                 break;
+            case 5:
+                mg->setSmoother(i,makeChebyshevSmootherOp(matrices[i]));
+                gsInfo << "Smoother for level " << i << ": Chebyshev\n";
+                break;
             default:
                 gsInfo << "Unknown smoother chosen.\n";
                 return EXIT_FAILURE;
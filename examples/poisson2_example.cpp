@@ -24,6 +24,7 @@ int main(int argc, char *argv[])
     index_t numRefine  = 5;
     index_t numElevate = 0;
     bool last = false;
+    bool batch = false;
     std::string fn("pde/poisson2d_bvp.xml");
 
     gsCmdLine cmd("Tutorial on solving a Poisson problem.");
@@ -33,6 +34,7 @@ int main(int argc, char *argv[])
     cmd.addString( "f", "file", "Input XML file", fn );
     cmd.addSwitch("last", "Solve solely for the last level of h-refinement", last);
     cmd.addSwitch("plot", "Create a ParaView visualization file with the solution", plot);
+    cmd.addSwitch("batch", "Sum the element forms by batched quadrature (option BatchQuadrature)", batch);
 
     try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
     //! [Parse command line]
@@ -86,6 +88,7 @@ int main(int argc, char *argv[])
     //! [Problem setup]
     gsExprAssembler<> A(1,1);
     A.setOptions(Aopt);
+    A.options().addSwitch("BatchQuadrature", "Batched quadrature of the element forms", batch);
 
     gsInfo<<"Active options:\n"<< A.options() <<"\n";
 
@@ -148,9 +148,13 @@ namespace internal
 /* ----------- Quadrature ----------- */
 #include <gsAssembler/gsQuadRule.h>
 #include <gsAssembler/gsQuadrature.h>
+#include <gsAssembler/gsWeightedRule.h>
+#include <gsAssembler/gsElementScheduler.h>
+#include <gsAssembler/gsAssemblyProfile.h>
 
 /* ----------- Assembler ----------- */
 #include <gsAssembler/gsAssembler.h>
+#include <gsAssembler/gsSumFactorization.h>
 #include <gsAssembler/gsGenericAssembler.h>
 #include <gsAssembler/gsPoissonAssembler.h>
 #include <gsAssembler/gsCDRAssembler.h>
@@ -181,6 +185,7 @@ namespace internal
 /* ----------- Ieti ----------- */
 #include <gsIeti/gsIetiMapper.h>
 #include <gsIeti/gsIetiSystem.h>
+#include <gsIeti/gsDistributedIetiSystem.h>
 #include <gsIeti/gsPrimalSystem.h>
 #include <gsIeti/gsScaledDirichletPrec.h>
 
@@ -27,6 +27,9 @@
 #include <gsPde/gsBoundaryConditions.h>
 
 #include <gsAssembler/gsQuadRule.h>
+#include <gsAssembler/gsQuadrature.h>
+#include <gsAssembler/gsElementScheduler.h>
+#include <gsAssembler/gsAssemblyProfile.h>
 #include <gsAssembler/gsSparseSystem.h>
 #include <gsAssembler/gsRemapInterface.h>
 #include <gsAssembler/gsCPPInterface.h>
@@ -294,9 +297,15 @@ protected: // *** Output data members ***
     /// must fit m_system.colBlocks().
     std::vector<gsMatrix<T> > m_ddof;
 
+    /// Timings of the element loops (option "Profile")
+    gsAssemblyProfile m_profile;
+
+    /// Number of element loops which wrote into m_system (see revision())
+    size_t m_revision;
+
 public:
 
-    gsAssembler() : m_options(defaultOptions())
+    gsAssembler() : m_options(defaultOptions()), m_revision(0)
     { }
 
     virtual ~gsAssembler()
@@ -420,6 +429,26 @@ public:  /* Virtual assembly routines*/
 
     gsOptionList & options() {return m_options;}
 
+    /// \brief Returns the timings of the phases of the element loops
+    /// (apply), recorded if the option "Profile" is set.
+    ///
+    /// The phases of a visitor are mapped as: evaluate() to
+    /// precompute, assemble() to evaluate and localToGlobal() to
+    /// push. The counters are accumulated over all loops, until
+    /// "Profile" is switched off or resetProfile() is called.
+    const gsAssemblyProfile & profile() const { return m_profile; }
+
+    /// Resets the counters of profile()
+    void resetProfile() { m_profile.reset(m_profile.enabled()); }
+
+    /// \brief Returns a counter which is incremented by every element
+    /// loop (apply, applyAll, push) writing into the system.
+    ///
+    /// Comparing two values tells whether the matrix has been
+    /// assembled again in between, eg. to update copies of it.
+    /// Changes made directly through system() are not counted.
+    size_t revision() const { return m_revision; }
+
 public: /* Element visitors */
 
     /// @brief Iterates over all elements of the domain and applies
@@ -427,12 +456,9 @@ public: /* Element visitors */
     template<class ElementVisitor>
     void push()
     {
-        for (size_t np = 0; np < m_pde_ptr->domain().nPatches(); ++np)
-        {
-            ElementVisitor visitor(*m_pde_ptr);
-            //Assemble (fill m_matrix and m_rhs) on patch np
-            apply(visitor, np);
-        }
+        ElementVisitor visitor(*m_pde_ptr);
+        //Assemble (fill m_matrix and m_rhs) on all patches
+        applyAll(visitor);
     }
 
     /// @brief Iterates over all elements of the boundaries \a BCs and
@@ -454,12 +480,9 @@ public: /* Element visitors */
     template<class ElementVisitor>
     void push(const ElementVisitor & visitor)
     {
-        for (size_t np = 0; np < m_pde_ptr->domain().nPatches(); ++np)
-        {
-            ElementVisitor curVisitor = visitor;
-            //Assemble (fill m_matrix and m_rhs) on patch np
-            apply(curVisitor, np);
-        }
+        ElementVisitor curVisitor = visitor;
+        //Assemble (fill m_matrix and m_rhs) on all patches
+        applyAll(curVisitor);
     }
 
     /// @brief Applies the \a BElementVisitor to the boundary condition \a BC
@@ -657,10 +680,30 @@ protected:
                size_t patchIndex = 0,
                boxSide side = boundary::none);
 
+    /// @brief Generic assembly routine for volume integrals over all
+    /// patches. The elements of all patches are distributed to the
+    /// threads in chunks (see gsElementScheduler)
+    /// \param[in] visitor The visitor for the volume integral
+    template<class ElementVisitor>
+    void applyAll(ElementVisitor & visitor);
+
     /// @brief Generic assembly routine for patch-interface integrals
     template<class InterfaceVisitor>
     void apply(InterfaceVisitor & visitor,
                const boundaryInterface & bi);
+
+    /// @brief Returns true if the sum-factorized visitors use
+    /// weighted quadrature (see gsSumFactorization)
+    bool weightedQuadrature() const
+    {
+        return m_options.askSwitch("SumFactorization", false) &&
+            gsQuadrature::WeightedQuadrature ==
+            m_options.askInt("quRule", gsQuadrature::GaussLegendre);
+    }
+
+    /// @brief Adds the per-thread systems \a sys (Scatter=1) to
+    /// m_system; to be called by every thread of the parallel region
+    void mergeLocal(std::vector<gsSparseSystem<T> > & sys);
 };
 
 template <class T>
@@ -673,6 +716,24 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
 
     const gsBasisRefs<T> bases(m_bases, patchIndex);
 
+#ifdef _OPENMP
+    // Thread-local systems (for scatter::local), only for volume
+    // integrals; boundary sides have too few elements to pay off
+    const bool localScatter = ( boundary::none == side &&
+        scatter::local == m_options.askInt("Scatter", scatter::critical) );
+    std::vector<gsSparseSystem<T> > lSystem(localScatter ? omp_get_max_threads() : 0);
+#endif
+    m_profile.enable(m_options.askSwitch("Profile", false));
+    ++m_revision;
+
+    // Weighted quadrature rules are shared by the thread-private
+    // visitors, compute them once
+    if ( boundary::none == side && weightedQuadrature() )
+    {
+        gsQuadRule<T> quRule;
+        visitor.initialize(bases, patchIndex, m_options, quRule);
+    }
+
 #pragma omp parallel
 {
     gsQuadRule<T> quRule ; // Quadrature rule
@@ -685,6 +746,8 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
     visitor_(visitor);
     const int tid = omp_get_thread_num();
     const int nt  = omp_get_num_threads();
+    const bool lcl = localScatter && nt > 1;
+    if (lcl) lSystem[tid].setupLike(m_system, numColNz());
 #else
     &visitor_ = visitor;
 #endif
@@ -704,23 +767,161 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
     for (; domIt->good(); domIt->next() )
 #endif
     {
+        m_profile.tic();
+
         // Map the Quadrature rule to the element
         quRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
+        m_profile.toc(gsAssemblyProfile::quadrature, 2.0 * quNodes.size(),
+                      (quNodes.size() + quWeights.size()) * sizeof(T));
 
         // Perform required evaluations on the quadrature nodes
         visitor_.evaluate(bases, patch, quNodes);
+        m_profile.toc(gsAssemblyProfile::precompute);
 
         // Assemble on element
         visitor_.assemble(*domIt, quWeights);
+        m_profile.toc(gsAssemblyProfile::evaluate);
 
         // Push to global matrix and right-hand side vector
+#ifdef _OPENMP
+        if (lcl)
+            visitor_.localToGlobal(patchIndex, m_ddof, lSystem[tid]);
+        else
+#endif
+#pragma omp critical(localToGlobal)
+        visitor_.localToGlobal(patchIndex, m_ddof, m_system);
+        m_profile.toc(gsAssemblyProfile::push);
+    }
+
+#ifdef _OPENMP
+    if (lcl) mergeLocal(lSystem);
+#endif
+}//omp parallel
+
+}
+
+
+template <class T>
+template<class ElementVisitor>
+void gsAssembler<T>::applyAll(ElementVisitor & visitor)
+{
+    // Work items of consecutive elements, over all patches -- using unknown 0
+    const gsElementScheduler<T> sched(m_bases[0], m_options.askInt("ElementChunk", 0));
+
+#ifdef _OPENMP
+    // Thread-local systems (for scatter::local)
+    const bool localScatter = (scatter::local == m_options.askInt("Scatter", scatter::critical));
+    std::vector<gsSparseSystem<T> > lSystem(localScatter ? omp_get_max_threads() : 0);
+#endif
+    m_profile.enable(m_options.askSwitch("Profile", false));
+    ++m_revision;
+
+    // Weighted quadrature rules are shared by the thread-private
+    // visitors, compute them once per patch
+    if ( weightedQuadrature() )
+    {
+        gsQuadRule<T> quRule;
+        for (size_t k = 0; k != m_bases[0].nBases(); ++k)
+            visitor.initialize(gsBasisRefs<T>(m_bases, k), k, m_options, quRule);
+    }
+
+#pragma omp parallel
+{
+    gsQuadRule<T> quRule ; // Quadrature rule
+    gsMatrix<T> quNodes  ; // Temp variable for mapped nodes
+    gsVector<T> quWeights; // Temp variable for mapped weights
+
+    ElementVisitor
+#ifdef _OPENMP
+    // Create thread-private visitor
+    visitor_(visitor);
+    const int tid = omp_get_thread_num();
+    const bool lcl = localScatter && omp_get_num_threads() > 1;
+    if (lcl) lSystem[tid].setupLike(m_system, numColNz());
+#else
+    &visitor_ = visitor;
+#endif
+
+    typename gsBasis<T>::domainIter domIt;
+    index_t patchIndex = -1;
+    const gsGeometry<T> * patch = NULL;
+
+#pragma omp for schedule(dynamic,1)
+    for (index_t w = 0; w < sched.size(); ++w)
+    {
+        if ( sched.moveTo(w, domIt, patchIndex) ) // new patch
+        {
+            // Initialize reference quadrature rule and visitor data
+            visitor_.initialize(gsBasisRefs<T>(m_bases, patchIndex),
+                                patchIndex, m_options, quRule);
+            patch = &m_pde_ptr->patches()[patchIndex];
+        }
+        const gsBasisRefs<T> bases(m_bases, patchIndex);
+
+        // Start iteration over the elements of the work item
+        for (index_t e = sched[w].first; e != sched[w].last; ++e, domIt->next() )
+        {
+            m_profile.tic();
+
+            // Map the Quadrature rule to the element
+            quRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
+            m_profile.toc(gsAssemblyProfile::quadrature, 2.0 * quNodes.size(),
+                          (quNodes.size() + quWeights.size()) * sizeof(T));
+
+            // Perform required evaluations on the quadrature nodes
+            visitor_.evaluate(bases, *patch, quNodes);
+            m_profile.toc(gsAssemblyProfile::precompute);
+
+            // Assemble on element
+            visitor_.assemble(*domIt, quWeights);
+            m_profile.toc(gsAssemblyProfile::evaluate);
+
+            // Push to global matrix and right-hand side vector
+#ifdef _OPENMP
+            if (lcl)
+                visitor_.localToGlobal(patchIndex, m_ddof, lSystem[tid]);
+            else
+#endif
 #pragma omp critical(localToGlobal)
-        visitor_.localToGlobal(patchIndex, m_ddof, m_system); // omp_locks inside
+            visitor_.localToGlobal(patchIndex, m_ddof, m_system);
+            m_profile.toc(gsAssemblyProfile::push);
+        }
     }
+
+#ifdef _OPENMP
+    if (lcl) mergeLocal(lSystem);
+#endif
 }//omp parallel
 
 }
 
+template <class T>
+void gsAssembler<T>::mergeLocal(std::vector<gsSparseSystem<T> > & sys)
+{
+#ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+    for (int s = 1; s < nt; s *= 2)
+    {
+#       pragma omp barrier
+        if ( 0 == tid % (2*s) && tid + s < nt )
+        {
+            sys[tid].add(sys[tid+s]);
+            sys[tid+s] = gsSparseSystem<T>();
+        }
+    }
+#   pragma omp barrier
+#   pragma omp single
+    {
+        m_system.add(sys.front());
+        sys.front() = gsSparseSystem<T>();
+        // room for boundary and interface terms pushed afterwards
+        m_system.matrix().reserveUpToPerColumn(numColNz());
+    }//implicit barrier
+#else
+    GISMO_UNUSED(sys);
+#endif
+}
 
 template <class T>
 template<class InterfaceVisitor>
@@ -737,7 +938,8 @@ void gsAssembler<T>::apply(InterfaceVisitor & visitor,
     gsQuadRule<T> quRule ; // Quadrature rule
     gsMatrix<T> quNodes1, quNodes2;// Mapped nodes
     gsVector<T> quWeights;         // Mapped weights
-    
+    ++m_revision;
+
     // Initialize
     visitor.initialize(B1, B2, bi, m_options, quRule);
 
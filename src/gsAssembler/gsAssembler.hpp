@@ -38,6 +38,10 @@ gsOptionList gsAssembler<T>::defaultOptions()
     opt.addReal("bdA", "Estimated nonzeros per column of the matrix: bdA*deg + bdB", 2.0  );
     opt.addInt ("bdB", "Estimated nonzeros per column of the matrix: bdA*deg + bdB", 1    );
     opt.addReal("bdO", "Overhead of sparse mem. allocation: (1+bdO)(bdA*deg + bdB) [0..1]", 0.333);
+    opt.addInt ("ElementChunk", "Number of consecutive elements per work item in parallel assembly (0: automatic)", 0);
+    opt.addInt ("Scatter", "Accumulation of element contributions in parallel assembly [0..1]: 0 critical section, 1 thread-local copies of the system (memory: one system per thread)", scatter::critical);
+    opt.addSwitch("SumFactorization", "Use sum factorization for element matrices on tensor-product bases (when supported by the visitor)", false);
+    opt.addSwitch("Profile", "Record the time spent in the phases of the element loops, per thread (see profile())", false);
     return opt;
 }
 
@@ -68,6 +68,23 @@ struct iFace
 
 };
 
+struct scatter
+{
+    enum strategy
+    {
+        /// Accumulate local contributions directly into the global
+        /// system, guarded by a critical section
+        critical = 0,
+
+        /// Accumulate local contributions into thread-local copies
+        /// of the global system, which are merged into the global
+        /// system at the end of the assembly loop. Avoids contention,
+        /// but every thread holds a sparse matrix of the size of the
+        /// global one
+        local    = 1
+    };
+};
+
 /*
     enum iFaceTopology
     {
@@ -0,0 +1,230 @@
+/** @file gsAssemblyProfile.h
+
+    @brief Per-phase and per-thread timing of element loops
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#pragma once
+
+#include <gsUtils/gsStopwatch.h>
+#include <iomanip>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace gismo
+{
+
+/**
+   @brief Collects the time, the number of calls, a flop estimate and
+   the amount of data written by the phases of an element loop, for
+   every thread separately.
+
+   The phases of an element are
+   - quadrature: mapping the quadrature rule to the element (gsQuadRule::mapTo)
+   - precompute: evaluation of the bases and geometry maps (gsExprHelper::precompute,
+     or gsVisitor::evaluate)
+   - evaluate: computation of the local matrices/values
+   - push: accumulation into the global system (or result)
+
+   Every thread keeps its own gsStopwatch: tic() starts the
+   element and every toc(phase) adds the time elapsed since the
+   previous tic()/toc() to \a phase. The flop estimates and the
+   numbers of bytes are provided by the caller, based on the sizes of
+   the element quantities (eg. quadrature nodes, local matrices);
+   they count the data produced in a phase, not the memory traffic.
+
+   If disabled (the default), tic() and toc() return immediately.
+
+   \ingroup Assembler
+*/
+class gsAssemblyProfile
+{
+public:
+
+    /// The phases of an element loop
+    enum phase
+    {
+        quadrature = 0,
+        precompute = 1,
+        evaluate   = 2,
+        push       = 3,
+        nPhases    = 4
+    };
+
+    /// The counters of a phase
+    struct counter
+    {
+        counter() : time(0), calls(0), flops(0), bytes(0) { }
+
+        counter & operator+=(const counter & other)
+        {
+            time  += other.time;
+            calls += other.calls;
+            flops += other.flops;
+            bytes += other.bytes;
+            return *this;
+        }
+
+        double  time;  ///< seconds
+        index_t calls;
+        double  flops; ///< estimated number of floating point operations
+        double  bytes; ///< size of the data produced
+    };
+
+private:
+
+    struct threadData
+    {
+        threadData() { }
+        // the stopwatch is not copied
+        threadData(const threadData & other) { *this = other; }
+        threadData & operator=(const threadData & other)
+        {
+            std::copy(other.c, other.c+nPhases, c);
+            return *this;
+        }
+
+        gsStopwatch sw;
+        counter     c[nPhases];
+        char        pad[64]; // no false sharing between threads
+    };
+
+public:
+
+    gsAssemblyProfile() : m_on(false) { }
+
+    /// Enables (or disables) the instrumentation and resets all counters
+    void reset(const bool on)
+    {
+        m_on = on;
+        std::vector<threadData>(on ? _maxThreads() : 0).swap(m_data);
+    }
+
+    /// Enables (or disables) the instrumentation. The counters are
+    /// kept if it is already enabled, for enough threads.
+    void enable(const bool on)
+    {
+        if ( on != m_on || (on && numThreads() < _maxThreads()) )
+            reset(on);
+    }
+
+    /// Returns true if the instrumentation is enabled
+    bool enabled() const { return m_on; }
+
+    /// Starts the timing of an element on the calling thread
+    void tic()
+    {
+        if (!m_on) return;
+        _mine().sw.restart();
+    }
+
+    /// Adds the time since the last tic() or toc() of the calling
+    /// thread to \a p, together with the estimates \a flops and \a bytes
+    void toc(const phase p, const double flops = 0, const double bytes = 0)
+    {
+        if (!m_on) return;
+        threadData & d = _mine();
+        counter & c = d.c[p];
+        c.time += d.sw.stop();
+        ++c.calls;
+        c.flops += flops;
+        c.bytes += bytes;
+        d.sw.restart();
+    }
+
+    /// Returns the number of threads that are recorded
+    index_t numThreads() const { return static_cast<index_t>(m_data.size()); }
+
+    /// Returns the counters of phase \a p on thread \a tid
+    const counter & get(const index_t tid, const phase p) const
+    { return m_data[tid].c[p]; }
+
+    /// Returns the counters of phase \a p, summed over all threads
+    counter total(const phase p) const
+    {
+        counter r;
+        for (size_t t = 0; t != m_data.size(); ++t)
+            r += m_data[t].c[p];
+        return r;
+    }
+
+    /// Returns the name of phase \a p
+    static const char * name(const phase p)
+    {
+        static const char * names[nPhases] =
+            {"quadrature", "precompute", "evaluate", "push"};
+        return names[p];
+    }
+
+    /// Prints a table of the counters of every phase and thread
+    std::ostream & print(std::ostream & os) const
+    {
+        if (!m_on)
+            return os << "Assembly profile: disabled.\n";
+        os << "Assembly profile (" << m_data.size() << " thread"
+           << (1==m_data.size() ? "" : "s") << "):\n"
+           << "  phase       thread     time [s]      calls      MFlop       MB\n";
+        const std::ios::fmtflags fl = os.flags();
+        const std::streamsize prec = os.precision();
+        os << std::fixed;
+        for (index_t p = 0; p != nPhases; ++p)
+        {
+            for (size_t t = 0; t <= m_data.size(); ++t)
+            {
+                const bool tot = (t == m_data.size());
+                if (tot && 1==m_data.size()) break;
+                const counter c = tot ? total(static_cast<phase>(p)) : m_data[t].c[p];
+                os << "  " << std::left << std::setw(12) << name(static_cast<phase>(p))
+                   << std::right << std::setw(6);
+                if (tot) os << "all"; else os << t;
+                os << std::setprecision(6) << std::setw(13) << c.time
+                   << std::setw(11) << c.calls
+                   << std::setprecision(3) << std::setw(11) << c.flops * 1e-6
+                   << std::setw(9) << c.bytes / 1048576.0 << "\n";
+            }
+        }
+        os.flags(fl);
+        os.precision(prec);
+        return os;
+    }
+
+    friend std::ostream & operator<<(std::ostream & os, const gsAssemblyProfile & p)
+    { return p.print(os); }
+
+private:
+
+    static index_t _maxThreads()
+    {
+#       ifdef _OPENMP
+        return omp_get_max_threads();
+#       else
+        return 1;
+#       endif
+    }
+
+    threadData & _mine()
+    {
+#       ifdef _OPENMP
+        return m_data[omp_get_thread_num()];
+#       else
+        return m_data.front();
+#       endif
+    }
+
+private:
+
+    bool m_on;
+
+    std::vector<threadData> m_data;
+};
+
+} // namespace gismo
@@ -0,0 +1,153 @@
+/** @file gsElementScheduler.h
+
+    @brief Distribution of the elements of a multi-basis to threads
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#pragma once
+
+#include <gsCore/gsMultiBasis.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace gismo
+{
+
+/**
+   @brief Splits the elements of all patches of a multi-basis into
+   work items of consecutive elements, which are processed by a
+   parallel loop.
+
+   Every work item is a range of consecutive elements of one
+   patch. The items of all patches form one global list, which is
+   traversed with dynamic scheduling: a thread that finishes its item
+   takes the next free one, no matter which patch it belongs to. This
+   balances the load between patches of very different size, and
+   every thread visits contiguous elements (sharing knot spans and
+   basis data), instead of every nt-th element.
+
+   Usage:
+   \code
+   gsElementScheduler<T> sched(mb);
+   #pragma omp parallel
+   {
+       typename gsBasis<T>::domainIter domIt;
+       index_t patch = -1;
+   #   pragma omp for schedule(dynamic,1)
+       for (index_t w = 0; w < sched.size(); ++w)
+       {
+           if ( sched.moveTo(w, domIt, patch) )
+           { ... } // new iterator on patch
+           for (index_t e = sched[w].first; e != sched[w].last; ++e, domIt->next())
+           { ... } // element e of patch
+       }
+   }
+   \endcode
+
+   \ingroup Assembler
+*/
+template<class T>
+class gsElementScheduler
+{
+public:
+
+    /// A range [first,last) of element indices on a patch
+    struct item
+    {
+        item(index_t _patch, index_t _first, index_t _last)
+        : patch(_patch), first(_first), last(_last) { }
+
+        index_t patch, first, last;
+    };
+
+public:
+
+    /// Creates the work items for all elements of \a mb, with at most
+    /// \a chunk elements each. If \a chunk is zero, it is chosen such
+    /// that every thread gets about eight work items.
+    explicit gsElementScheduler(const gsMultiBasis<T> & mb, index_t chunk = 0)
+    : m_mb(&mb)
+    {
+        const index_t np = mb.nBases();
+        m_offset.resize(np+1);
+        m_offset.front() = 0;
+        for (index_t p = 0; p != np; ++p)
+            m_offset[p+1] = m_offset[p] + mb.basis(p).numElements();
+
+        if ( chunk < 1 )
+        {
+#           ifdef _OPENMP
+            const index_t nt = omp_get_max_threads();
+#           else
+            const index_t nt = 1;
+#           endif
+            chunk = math::max( m_offset.back() / (8*nt), (index_t)1 );
+        }
+
+        m_items.reserve( m_offset.back() / chunk + np );
+        for (index_t p = 0; p != np; ++p)
+        {
+            const index_t ne = m_offset[p+1] - m_offset[p];
+            for (index_t e = 0; e < ne; e += chunk)
+                m_items.push_back( item(p, e, math::min(e+chunk, ne)) );
+        }
+    }
+
+    /// Returns the number of work items
+    index_t size() const { return m_items.size(); }
+
+    /// Returns the work item \a i
+    const item & operator[](const index_t i) const { return m_items[i]; }
+
+    /// Returns the total number of elements
+    index_t numElements() const { return m_offset.back(); }
+
+    /// Returns the global index of the first element of patch \a p,
+    /// ie. element \a e of patch \a p has the global index
+    /// elementOffset(p)+e
+    index_t elementOffset(const index_t p) const { return m_offset[p]; }
+
+    /// \brief Points the iterator \a domIt to the first element of
+    /// work item \a i.
+    ///
+    /// The index of the patch of \a domIt is kept in \a patch
+    /// (initially -1). A new iterator is created only if the patch
+    /// changes or the item lies before the current element, in which
+    /// case true is returned.
+    bool moveTo(const index_t i, typename gsBasis<T>::domainIter & domIt,
+                index_t & patch) const
+    {
+        const item & w = m_items[i];
+        bool created = false;
+        if ( w.patch != patch || nullptr==domIt ||
+             static_cast<index_t>(domIt->id()) > w.first )
+        {
+            domIt = m_mb->basis(w.patch).makeDomainIterator();
+            patch = w.patch;
+            created = true;
+        }
+        const index_t inc = w.first - static_cast<index_t>(domIt->id());
+        if ( 0 != inc )
+            domIt->next(inc);
+        return created;
+    }
+
+private:
+
+    const gsMultiBasis<T> * m_mb;
+
+    std::vector<index_t> m_offset;
+
+    std::vector<item> m_items;
+};
+
+} // namespace gismo
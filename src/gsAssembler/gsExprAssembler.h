@@ -16,6 +16,10 @@
 #include <gsUtils/gsPointGrid.h>
 #include <gsAssembler/gsQuadrature.h>
 #include <gsAssembler/gsExprHelper.h>
+#include <gsAssembler/gsElementScheduler.h>
+#include <gsAssembler/gsAssemblyProfile.h>
+#include <gsHSplines/gsHTensorBasis.h>
+#include <gsSolver/gsLinearOperator.h>
 
 #include <gsAssembler/gsCPPInterface.h>
 
@@ -42,6 +46,28 @@ private:
     std::vector<gsFeSpaceData<T>*> m_vrow;
     std::vector<gsFeSpaceData<T>*> m_vcol;
 
+    // Stored sparsity pattern (see computePattern)
+    std::vector<index_t>           m_elOffset; ///< first element index of every patch
+    std::vector<gsMatrix<index_t> > m_slots;   ///< positions of element blocks in m_matrix
+    index_t                         m_patternNz;
+
+    // System of the previous call of assembleIncremental
+    struct incrementalData
+    {
+        gsMultiBasis<T>   basis;  ///< integration elements
+        gsDofMapper       mapper;
+        gsMatrix<T>       fixedDofs;
+        gsSparseMatrix<T> matrix;
+        gsMatrix<T>       rhs;
+
+        void clear() { *this = incrementalData(); }
+    } m_incr;
+
+    // If set, assemble() visits only the elements marked true
+    const std::vector<bool> * m_elMask;
+
+    gsAssemblyProfile m_profile; ///< timings of assemble() (option "Profile")
+
     typedef typename gsExprHelper<T>::nullExpr    nullExpr;
 
 public:
@@ -72,7 +98,7 @@ public:
     /// \param _cBlocks Number of spaces for solution variables
     gsExprAssembler(index_t _rBlocks = 1, index_t _cBlocks = 1)
     : m_exprdata(gsExprHelper<T>::make()), m_gmap(nullptr), m_options(defaultOptions()),
-      m_vrow(_rBlocks,nullptr), m_vcol(_cBlocks,nullptr)
+      m_vrow(_rBlocks,nullptr), m_vcol(_cBlocks,nullptr), m_patternNz(0), m_elMask(nullptr)
     { }
 
     // The copy constructor replicates the same environent but does
@@ -112,6 +138,16 @@ public:
     /// Returns a reference to the options structure
     gsOptionList & options() {return m_options;}
 
+    /// \brief Returns the timings of the phases of assemble(),
+    /// recorded if the option "Profile" is set.
+    ///
+    /// The counters are accumulated over all calls, until "Profile"
+    /// is switched off or resetProfile() is called.
+    const gsAssemblyProfile & profile() const { return m_profile; }
+
+    /// Resets the counters of profile()
+    void resetProfile() { m_profile.reset(m_profile.enabled()); }
+
     /// @brief Returns the left-hand global matrix
     const gsSparseMatrix<T> & matrix() const { return m_matrix; }
 
@@ -134,7 +170,10 @@ public:
     /// \brief Sets the domain of integration.
     /// \warning Must be called before any computation is requested
     void setIntegrationElements(const gsMultiBasis<T> & mesh)
-    { m_exprdata->setMultiBasis(mesh); }
+    {
+        m_exprdata->setMultiBasis(mesh);
+        m_exprdata->clearMapCache();
+    }
 
     /// \brief Set the geometrymap ( used for interface assembly)
     /// \warning Must be called before any computation is requested
@@ -298,32 +337,74 @@ public:
     void initMatrix()
     {
         resetDimensions();
-        clearMatrix();
+        clearPattern();
+        if ( m_options.askSwitch("ReusePattern", false) )
+            computePattern();
+        else
+            clearMatrix();
     }
 
     void clearRhs() { m_rhs.setZero(); }
 
     void clearMatrix()
     {
+        if ( !m_slots.empty() )
+        {
+            // Keep the sparsity pattern, only reset the values
+            if ( m_matrix.rows()==numTestDofs() && m_matrix.cols()==numDofs()
+                 && m_matrix.nonZeros()==m_patternNz )
+                m_matrix.coeffs().setZero();
+            else // the matrix was taken away (eg. by giveMatrix)
+                computePattern();
+            return;
+        }
+
         m_matrix = gsSparseMatrix<T>(numTestDofs(), numDofs());
 
         if ( 0 == m_matrix.rows() || 0 == m_matrix.cols() )
             gsWarn << " No internal DOFs, zero sized system.\n";
         else
-        {
-            // Pick up values from options
-            const T bdA       = m_options.getReal("bdA");
-            const index_t bdB = m_options.getInt("bdB");
-            const T bdO       = m_options.getReal("bdO");
-            T nz = 1;
-            const short_t dim = m_exprdata->multiBasis().domainDim();
-            for (short_t i = 0; i != dim; ++i)
-                nz *= bdA * static_cast<T>(m_exprdata->multiBasis().maxDegree(i)) + static_cast<T>(bdB);
-
-            m_matrix.reservePerColumn(numBlocks()*cast<T,index_t>(nz*(1.0+bdO)) );
-        }
+            m_matrix.reservePerColumn( _nzPerColumn() );
     }
 
+    /// \brief Computes the sparsity pattern of the system matrix and
+    /// keeps it for subsequent assemblies.
+    ///
+    /// The pattern is obtained symbolically from the DoF mappers and
+    /// the element connectivity: every pair of free DoFs of a
+    /// test and a trial space which are active on a common element
+    /// is a non-zero. For every element the positions of its
+    /// contributions in the compressed matrix storage are stored as
+    /// well. Afterwards, clearMatrix() only resets the values and
+    /// assemble() adds the element contributions into the known
+    /// positions, without searching or inserting in the matrix.
+    ///
+    /// This is done automatically by initSystem()/initMatrix() if the
+    /// option "ReusePattern" is set.
+    ///
+    /// \warning The pattern must be recomputed (or discarded by
+    /// clearPattern()) whenever the spaces, their DoF mappers or the
+    /// integration elements change.
+    void computePattern();
+
+    /// \brief Discards the sparsity pattern computed by computePattern()
+    void clearPattern()
+    {
+        m_elOffset.clear();
+        m_slots.clear();
+        m_patternNz = 0;
+    }
+
+    /// Returns true if a sparsity pattern is kept for subsequent assemblies
+    bool hasPattern() const { return !m_slots.empty(); }
+
+    /// \brief Discards the geometry map data kept if the option
+    /// "CacheMaps" is set.
+    ///
+    /// \warning Must be called whenever a geometry map or the
+    /// quadrature options change between two assemblies.
+    void clearMapCache() { m_exprdata->clearMapCache(); }
+
     /// \brief Initializes the right-hand side vector only
     void initVector(const index_t numRhs = 1)
     {
@@ -364,15 +445,52 @@ public:
     /// \sa gsExprAssembler::setIntegrationElements
     template<class... expr> void assemble(const expr &... args);
 
+    /// \brief Adds the expressions \a args to the system matrix/rhs,
+    /// re-using the system of the previous call where possible.
+    ///
+    /// Meant for adaptive loops on hierarchical (THB) bases: after
+    /// refining the integration elements (and calling setup() and
+    /// initSystem() again), only the elements on which a basis
+    /// function changed are integrated. A basis function is changed
+    /// if it is new, if an element of its support was refined or if
+    /// its fixed (Dirichlet) value differs. All other entries are
+    /// transferred from the previous system via the old-to-new DoF
+    /// map, identifying the functions by their level and tensor index.
+    ///
+    /// \note Fixed values obtained by a global interpolation or
+    /// projection usually differ slightly on the whole boundary, so
+    /// that all boundary elements are integrated again.
+    ///
+    /// The first call, or a call on non-hierarchical bases or on more
+    /// than one space, performs a full assemble().
+    ///
+    /// \warning The geometry map and the expressions \a args must be
+    /// the same in all calls, otherwise call clearIncremental() first.
+    template<class... expr> void assembleIncremental(const expr &... args);
+
+    /// \brief Discards the system kept by assembleIncremental()
+    void clearIncremental() { m_incr.clear(); }
+
     /// \brief Adds the expressions \a args to the system matrix/rhs
     /// The arguments are considered as integrals over the boundary
     /// parts in \a BCs
     template<class... expr> void assembleBdr(const bcRefList & BCs, expr&... args);
 
     template<class... expr> void assembleIfc(const ifContainer & iFaces, expr... args);
-    /*
-      template<class... expr> void collocate(expr... args);// eg. collocate(-ilapl(u), f)
-    */
+
+    /// \brief Adds the collocation system of the equation \a lhs =
+    /// \a rhs to the system matrix/rhs, eg. collocate(-ilapl(u,G), f).
+    ///
+    /// The collocation points are the anchors (Greville points) of
+    /// the free basis functions of the space of \a lhs, which must be
+    /// scalar and numbered like the test space. Row i of the system
+    /// is the equation at the anchor of DoF i; eliminated (Dirichlet)
+    /// DoFs are moved to the right-hand side.
+    ///
+    /// The points of a patch are evaluated in batches, in parallel;
+    /// every row is computed by one thread.
+    template<class E1, class E2>
+    void collocate(const expr::_expr<E1> & lhs, const expr::_expr<E2> & rhs);
 
     /// \brief Assembles the Jacobian matrix of the expression \a args with
     // respect to the solution \a u
@@ -381,8 +499,208 @@ public:
     template<class expr> void assembleJacobianIfc(const ifContainer & iFaces,
                                                   const expr residual, solution  u);
 
+    /// \brief Computes \a y = A \a x, where A is the system matrix
+    /// of the bilinear forms \a args, without assembling A.
+    ///
+    /// The element matrices are computed on the fly and multiplied
+    /// with the local coefficients of \a x (one column per vector),
+    /// so that no sparse matrix is stored. The result coincides with
+    /// matrix()*x after assemble(args...) on a cleared system.
+    template<class... expr>
+    void matrixFreeApply(const gsMatrix<T> & x, gsMatrix<T> & y,
+                         const expr &... args);
+
+    /// \brief Returns a matrix-free linear operator for the bilinear
+    /// forms \a args, see matrixFreeApply.
+    ///
+    /// The operator refers to this assembler, which must outlive
+    /// it. It can be used, eg., with gsConjugateGradient or as the
+    /// finest level operator of gsMultiGridOp.
+    template<class... expr>
+    typename gsLinearOperator<T>::uPtr matrixFreeOperator(const expr &... args)
+    {
+        return makeLinearOp<T>(
+            [this, args...](const gsMatrix<T> & x, gsMatrix<T> & y)
+            { this->matrixFreeApply(x, y, args...); },
+            numTestDofs(), numDofs() );
+    }
+
 private:
 
+    /// Estimated number of non-zeros per column of the system matrix,
+    /// computed from the options bdA, bdB and bdO
+    index_t _nzPerColumn()
+    {
+        // Pick up values from options
+        const T bdA       = m_options.getReal("bdA");
+        const index_t bdB = m_options.getInt("bdB");
+        const T bdO       = m_options.getReal("bdO");
+        T nz = 1;
+        const short_t dim = m_exprdata->multiBasis().domainDim();
+        for (short_t i = 0; i != dim; ++i)
+            nz *= bdA * static_cast<T>(m_exprdata->multiBasis().maxDegree(i)) + static_cast<T>(bdB);
+        return numBlocks()*cast<T,index_t>(nz*(1.0+bdO));
+    }
+
+    /// Initializes \a mat and \a rhs as (empty) thread-local copies
+    /// of the global system
+    void _initLocal(gsSparseMatrix<T> & mat, gsMatrix<T> & rhs)
+    {
+        mat.resize(m_matrix.rows(), m_matrix.cols());
+        if ( 0 != mat.rows() && 0 != mat.cols() )
+            mat.reservePerColumn( _nzPerColumn() );
+        rhs.setZero(m_rhs.rows(), m_rhs.cols());
+    }
+
+    /// Adds the thread-local systems \a mat and \a rhs to the global
+    /// system. Must be called by all threads of the team. The local
+    /// systems are summed pairwise, therefore the result does not
+    /// depend on thread scheduling for a fixed number of threads.
+    void _mergeLocal(std::vector<gsSparseMatrix<T> > & mat,
+                     std::vector<gsMatrix<T> > & rhs)
+    {
+#       ifdef _OPENMP
+        const int tid = omp_get_thread_num();
+        const int nt  = omp_get_num_threads();
+        for (int s = 1; s < nt; s *= 2)
+        {
+#           pragma omp barrier
+            if ( 0 == tid % (2*s) && tid + s < nt )
+            {
+                mat[tid] += mat[tid+s];
+                rhs[tid] += rhs[tid+s];
+                mat[tid+s].clear();
+            }
+        }
+#       pragma omp barrier
+#       pragma omp single
+        {
+            m_matrix += mat.front();
+            m_rhs    += rhs.front();
+            mat.front().clear();
+        }//implicit barrier
+#       else
+        GISMO_UNUSED(mat); GISMO_UNUSED(rhs);
+#       endif
+    }
+
+    /// Computes the positions m_slots of the element contributions
+    /// in the (compressed) system matrix
+    void _computeSlots();
+
+    /// Compresses the system matrix after assembly. If a stored
+    /// pattern was extended (eg. by interface terms), the element
+    /// positions are updated.
+    void _finalizeMatrix()
+    {
+        m_matrix.makeCompressed();
+        if ( !m_slots.empty() && m_matrix.nonZeros()!=m_patternNz )
+            _computeSlots();
+    }
+
+    template<short_t d>
+    static bool _hierarchicalKeys(const gsBasis<T> & b,
+                                  std::vector<std::pair<index_t,index_t> > & keys)
+    {
+        const gsHTensorBasis<d,T> * hb = dynamic_cast<const gsHTensorBasis<d,T>*>(&b);
+        if (nullptr==hb) return false;
+        keys.resize(hb->size());
+        for (index_t i = 0; i != hb->size(); ++i)
+            keys[i] = std::make_pair(hb->levelOf(i), hb->flatTensorIndexOf(i));
+        return true;
+    }
+
+    /// Computes in \a keys the pairs (level, tensor index) of the
+    /// functions of \a b, returns false if \a b is not hierarchical
+    static bool _hierarchicalKeys(const gsBasis<T> & b,
+                                  std::vector<std::pair<index_t,index_t> > & keys)
+    {
+        switch (b.domainDim())
+        {
+        case 1: return _hierarchicalKeys<1>(b, keys);
+        case 2: return _hierarchicalKeys<2>(b, keys);
+        case 3: return _hierarchicalKeys<3>(b, keys);
+        case 4: return _hierarchicalKeys<4>(b, keys);
+        default: return false;
+        }
+    }
+
+    /// The corners of the current element of \a domIt
+    static std::vector<T> _cellKey(const gsDomainIterator<T> & domIt)
+    {
+        std::vector<T> k(domIt.lowerCorner().data(),
+                         domIt.lowerCorner().data() + domIt.lowerCorner().size());
+        k.insert(k.end(), domIt.upperCorner().data(),
+                 domIt.upperCorner().data() + domIt.upperCorner().size());
+        return k;
+    }
+
+    /// Computes in \a ind the global indices of the basis functions
+    /// of space \a sd which are active at \a pt on \a patch
+    static void _activeIndices(const gsFeSpaceData<T> & sd, const index_t patch,
+                               const gsMatrix<T> & pt, gsMatrix<index_t> & act,
+                               gsVector<index_t> & ind)
+    {
+        sd.fs->piece(patch).active_into(pt, act);
+        const index_t na = act.rows();
+        ind.resize(sd.dim * na);
+        for (index_t c = 0; c != sd.dim; ++c)
+            for (index_t i = 0; i != na; ++i)
+                ind[c*na+i] = sd.mapper.index(act.at(i), patch, c);
+    }
+
+    /// Groups the work items of \a sched into colors, such that no
+    /// two items of the same color have an active degree of freedom
+    /// of the space \a u in common (greedy coloring)
+    static void _colorItems(const gsElementScheduler<T> & sched,
+                            const expr::gsFeSpace<T> & u,
+                            std::vector<std::vector<index_t> > & colors)
+    {
+        const gsDofMapper & map = u.mapper();
+        std::vector<std::vector<index_t> > dofs(sched.size());
+        typename gsBasis<T>::domainIter domIt;
+        index_t patch = -1;
+        gsMatrix<T> pt;
+        gsMatrix<index_t> act;
+        for (index_t w = 0; w != sched.size(); ++w)
+        {
+            sched.moveTo(w, domIt, patch);
+            std::vector<index_t> & d = dofs[w];
+            for (index_t e = sched[w].first; e != sched[w].last; ++e, domIt->next())
+            {
+                pt = ( domIt->lowerCorner() + domIt->upperCorner() ) / 2;
+                u.source().piece(patch).active_into(pt, act);
+                for (index_t c = 0; c != u.dim(); ++c)
+                    for (index_t i = 0; i != act.rows(); ++i)
+                        d.push_back( map.index(act.at(i), patch, c) );
+            }
+            std::sort(d.begin(), d.end());
+            d.erase(std::unique(d.begin(), d.end()), d.end());
+        }
+
+        // stamp[i]==c if DoF i is active on an item of color c
+        std::vector<index_t> stamp(map.size(), -1), color(sched.size(), -1);
+        colors.clear();
+        for (index_t left = sched.size(), c = 0; 0 != left; ++c)
+        {
+            colors.push_back( std::vector<index_t>() );
+            for (index_t w = 0; w != sched.size(); ++w)
+            {
+                if ( -1 != color[w] ) continue;
+                const std::vector<index_t> & d = dofs[w];
+                bool free = true;
+                for (size_t i = 0; free && i != d.size(); ++i)
+                    free = (c != stamp[d[i]]);
+                if ( !free ) continue;
+                for (size_t i = 0; i != d.size(); ++i)
+                    stamp[d[i]] = c;
+                color[w] = c;
+                colors.back().push_back(w);
+                --left;
+            }
+        }
+    }
+
     void _blockDims(gsVector<index_t> & rowSizes,
                     gsVector<index_t> & colSizes)
     {
@@ -439,22 +757,47 @@ private:
         gsMatrix<T>       & m_rhs;
         const gsVector<T> & m_quWeights;
         bool m_elim;
+        bool m_batch;  // use expr::batch_quadrature ?
+        bool m_shared; // is m_matrix/m_rhs shared among threads ?
         gsMatrix<T>         localMat;
-        gsMatrix<T>         aux;
+        gsMatrix<T>         aux, batchA, batchB;
+
+        // Positions of the element contributions in m_matrix (if any)
+        const std::vector<gsMatrix<index_t> > * m_slots;
+        index_t m_nr, m_nc, m_el;
+
+        gsAssemblyProfile * m_prof;
 
         _eval(gsSparseMatrix<T> & _matrix,
               gsMatrix<T>       & _rhs,
-              const gsVector<>  & _quWeights)
+              const gsVector<>  & _quWeights,
+              bool _shared = true)
         : m_matrix(_matrix), m_rhs(_rhs),
-          m_quWeights(_quWeights), m_elim(true)
+          m_quWeights(_quWeights), m_elim(true), m_batch(false), m_shared(_shared),
+          m_slots(nullptr), m_nr(0), m_nc(0), m_el(0), m_prof(nullptr)
         { }
 
         void setElim(bool elim) {m_elim = elim;}
 
+        void setBatch(bool batch) {m_batch = batch;}
+
+        void setProfile(gsAssemblyProfile & prof)
+        { m_prof = prof.enabled() ? &prof : nullptr; }
+
+        void setSlots(const std::vector<gsMatrix<index_t> > & slots,
+                      const index_t nr, const index_t nc)
+        { m_slots = &slots; m_nr = nr; m_nc = nc; }
+
+        void setElement(const index_t el) { m_el = el; }
+
         template <typename E> void operator() (const gismo::expr::_expr<E> & ee)
         {
             // ------- Compute  -------
             quadrature(ee,localMat);
+            if (m_prof)
+                m_prof->toc(gsAssemblyProfile::evaluate,
+                            2.0 * m_quWeights.size() * localMat.size(),
+                            localMat.size() * sizeof(T));
 
             //  ------- Accumulate  -------
             if (E::isMatrix())
@@ -468,6 +811,8 @@ private:
                 GISMO_ERROR("Something went terribly wrong at this point");
                 //GISMO_ASSERTrowSpan() && (!colSpan())
             }
+            if (m_prof)
+                m_prof->toc(gsAssemblyProfile::push, localMat.size());
 
         }// operator()
 
@@ -476,6 +821,11 @@ private:
                                gsMatrix<T> & lm)
         {
             // ------- Compute  -------
+            if ( m_batch &&
+                 expr::batch_quadrature<E>::compute(static_cast<const E&>(ee),
+                                                    m_quWeights, lm, batchA, batchB) )
+                return;
+
             const T * w = m_quWeights.data();
             lm.noalias() = (*w) * ee.eval(0);
             for (index_t k = 1; k != m_quWeights.rows(); ++k)
@@ -545,6 +895,8 @@ private:
             gsMatrix<index_t> & rowInd0 = const_cast<gsMatrix<index_t>&>(v.data().actives);
             gsMatrix<index_t> & colInd0 = (isMatrix ? const_cast<gsMatrix<index_t>&>(u.data().actives) : rowInd0);
             const gsMatrix<T> & fixedDofs = (isMatrix ? u.fixedPart() : gsMatrix<T>());
+            const gsMatrix<index_t> * slots = (isMatrix && nullptr!=m_slots ?
+                &(*m_slots)[(m_el*m_nr + v.id())*m_nc + u.id()] : nullptr);
 
             if (isMatrix)
             {
@@ -554,6 +906,10 @@ private:
                 GISMO_ASSERT( colMap.boundarySize()==fixedDofs.size(),
                               "Invalid values for fixed part");
 
+                GISMO_ASSERT( nullptr==slots || (slots->rows()==localMat.rows() &&
+                                                 slots->cols()==localMat.cols()),
+                              "The stored sparsity pattern does not match the element.");
+
                 //GISMO_ASSERT( colMap.boundarySize()==0 || m_rhs.cols()==1,
                 //              "Invalid values for fixed part");
             }
@@ -582,16 +938,34 @@ private:
                                         // If matrix is symmetric, we could
                                         // store only lower triangular part
                                         //if ( (!symm) || jj <= ii )
-#                                       pragma omp critical (acc_m_matrix)
-                                        m_matrix.coeffRef(ii, jj) += localMat(rls+i,cls+j);
+                                        if (nullptr!=slots)
+                                        {
+                                            // known position, no search
+                                            T & val = m_matrix.valuePtr()[(*slots)(rls+i,cls+j)];
+#                                           pragma omp atomic
+                                            val += localMat(rls+i,cls+j);
+                                        }
+                                        else if (m_shared)
+                                        {
+#                                           pragma omp critical (acc_m_matrix)
+                                            m_matrix.coeffRef(ii, jj) += localMat(rls+i,cls+j);
+                                        }
+                                        else
+                                            m_matrix.coeffRef(ii, jj) += localMat(rls+i,cls+j);
                                     }
                                     else if (elim) // colMap.is_boundary_index(jj) )
                                     {
                                         // Symmetric treatment of eliminated BCs
                                         // GISMO_ASSERT(1==m_rhs.cols(), "-");
-#                                       pragma omp critical (acc_m_rhs)
-                                        m_rhs.at(ii) -= localMat(rls+i,cls+j) *
+                                        const T val = localMat(rls+i,cls+j) *
                                             fixedDofs.at(colMap.global_to_bindex(jj));
+                                        if (m_shared)
+                                        {
+#                                           pragma omp critical (acc_m_rhs)
+                                            m_rhs.at(ii) -= val;
+                                        }
+                                        else
+                                            m_rhs.at(ii) -= val;
                                     }
                                 }
                             }
@@ -599,8 +973,13 @@ private:
                         else
                         {
                             //The right-hand side can have more than one columns
-#                           pragma omp critical (acc_m_rhs)
-                            m_rhs.row(ii) += localMat.row(rls+i);
+                            if (m_shared)
+                            {
+#                               pragma omp critical (acc_m_rhs)
+                                m_rhs.row(ii) += localMat.row(rls+i);
+                            }
+                            else
+                                m_rhs.row(ii) += localMat.row(rls+i);
                         }
                     }
                 }
@@ -609,6 +988,78 @@ private:
 
     };
 
+    // Applies the element matrices to a vector (matrix-free)
+    struct _evalApply
+    {
+        const gsMatrix<T> & m_x;
+        gsMatrix<T>       & m_y;
+        const gsVector<T> & m_quWeights;
+        const bool          m_batch; // use expr::batch_quadrature ?
+        gsMatrix<T>         localMat, localX, batchA, batchB;
+
+        _evalApply(const gsMatrix<T> & _x, gsMatrix<T> & _y,
+                   const gsVector<T> & _quWeights, const bool _batch)
+        : m_x(_x), m_y(_y), m_quWeights(_quWeights), m_batch(_batch)
+        { }
+
+        template <typename E> void operator() (const gismo::expr::_expr<E> & ee)
+        {
+            GISMO_ASSERT(E::isMatrix(), "Expecting a bilinear (matrix) expression.");
+
+            // ------- Compute  -------
+            if ( !m_batch ||
+                 !expr::batch_quadrature<E>::compute(static_cast<const E&>(ee), m_quWeights,
+                                                     localMat, batchA, batchB) )
+            {
+                const T * w = m_quWeights.data();
+                localMat.noalias() = (*w) * ee.eval(0);
+                for (index_t k = 1; k != m_quWeights.rows(); ++k)
+                    localMat.noalias() += (*(++w)) * ee.eval(k);
+            }
+
+            //  ------- Apply  -------
+            apply(ee.rowVar(), ee.colVar());
+        }
+
+        void operator() (const expr::_expr<expr::gsNullExpr<T> > &) {}
+
+        void apply(const expr::gsFeSpace<T> & v,
+                   const expr::gsFeSpace<T> & u)
+        {
+            const gsDofMapper & rowMap = v.mapper();
+            const gsDofMapper & colMap = u.mapper();
+            const gsMatrix<index_t> & rowInd0 = v.data().actives;
+            const gsMatrix<index_t> & colInd0 = u.data().actives;
+
+            // Gather the local coefficients (zero on fixed DoFs)
+            localX.setZero(localMat.cols(), m_x.cols());
+            for (index_t c = 0; c != u.dim(); ++c)
+            {
+                const index_t cls = c * colInd0.rows(); //local stride
+                for (index_t j = 0; j != colInd0.rows(); ++j)
+                {
+                    const index_t jj = colMap.index(colInd0.at(j),u.data().patchId,c);
+                    if ( colMap.is_free_index(jj) )
+                        localX.row(cls+j) = m_x.row(jj);
+                }
+            }
+
+            localX = localMat * localX;
+
+            // Scatter to the free DoFs of the result
+            for (index_t r = 0; r != v.dim(); ++r)
+            {
+                const index_t rls = r * rowInd0.rows(); //local stride
+                for (index_t i = 0; i != rowInd0.rows(); ++i)
+                {
+                    const index_t ii = rowMap.index(rowInd0.at(i),v.data().patchId,r);
+                    if ( rowMap.is_free_index(ii) )
+                        m_y.row(ii) += localX.row(rls+i);
+                }
+            }
+        }
+    };
+
 }; // gsExprAssembler
 
 template<class T>
@@ -624,6 +1075,12 @@ gsOptionList gsExprAssembler<T>::defaultOptions()
     opt.addReal("bdO", "Overhead of sparse mem. allocation: (1+bdO)(bdA*deg + bdB) [0..1]", 0.333);
     opt.addSwitch("flipSide", "Flip side of interface where integration is performed.", false);
     opt.addSwitch("movingInterface", "Used in interface assembly when interface is not stationary.", false);
+    opt.addSwitch("ReusePattern", "Compute the sparsity pattern of the matrix once at initialization and only refill its values in subsequent assemblies", false);
+    opt.addInt("ElementChunk", "Number of consecutive elements per work item in parallel assembly (0: automatic)", 0);
+    opt.addSwitch("CacheMaps", "Keep the geometry map data of all elements for subsequent assemblies (see clearMapCache)", false);
+    opt.addInt("Scatter", "Accumulation of element contributions in parallel assembly [0..1]: 0 critical section, 1 thread-local copies of the system (memory: one system per thread)", scatter::critical);
+    opt.addSwitch("BatchQuadrature", "Sum the outer-product forms A*B.tr()*s over the quadrature points of an element by one matrix product (the factors are evaluated point by point)", false);
+    opt.addSwitch("Profile", "Record the time spent in the phases of assemble(), per thread (see profile())", false);
     return opt;
 
     /// dirichlet treatment? elimination ????
@@ -696,6 +1153,113 @@ void gsExprAssembler<T>::setFixedDofs(const gsMatrix<T> & coefMatrix, short_t un
 } // setFixedDofs
 
 
+template<class T> void gsExprAssembler<T>::computePattern()
+{
+    GISMO_ASSERT( m_vcol.back()->mapper.isFinalized() && m_vrow.back()->mapper.isFinalized(),
+                  "initSystem() has not been called.");
+    clearPattern();
+    m_matrix = gsSparseMatrix<T>(numTestDofs(), numDofs());
+    if ( 0 == m_matrix.rows() || 0 == m_matrix.cols() )
+    {
+        gsWarn << " No internal DOFs, zero sized system.\n";
+        return;
+    }
+    m_matrix.reservePerColumn( _nzPerColumn() );
+
+    const gsMultiBasis<T> & mb = m_exprdata->multiBasis();
+    const size_t nr = m_vrow.size(), nc = m_vcol.size();
+    gsMatrix<T> pt;
+    gsMatrix<index_t> act;
+    std::vector<gsVector<index_t> > rInd(nr), cInd(nc);
+
+    for (size_t p = 0; p != mb.nBases(); ++p)
+    {
+        typename gsBasis<T>::domainIter domIt = mb.basis(p).makeDomainIterator();
+        for (; domIt->good(); domIt->next() )
+        {
+            // Any point inside the element gives all the active functions
+            pt = ( domIt->lowerCorner() + domIt->upperCorner() ) / 2;
+            for (size_t r = 0; r != nr; ++r)
+                _activeIndices(*m_vrow[r], p, pt, act, rInd[r]);
+            for (size_t c = 0; c != nc; ++c)
+                _activeIndices(*m_vcol[c], p, pt, act, cInd[c]);
+
+            for (size_t r = 0; r != nr; ++r)
+                for (size_t c = 0; c != nc; ++c)
+                    for (index_t j = 0; j != cInd[c].size(); ++j)
+                    {
+                        const index_t jj = cInd[c][j];
+                        if ( !m_vcol[c]->mapper.is_free_index(jj) ) continue;
+                        for (index_t i = 0; i != rInd[r].size(); ++i)
+                        {
+                            const index_t ii = rInd[r][i];
+                            if ( m_vrow[r]->mapper.is_free_index(ii) )
+                                m_matrix.coeffRef(ii, jj); // structural zero
+                        }
+                    }
+        }
+    }
+
+    m_matrix.makeCompressed();
+    _computeSlots();
+}
+
+template<class T> void gsExprAssembler<T>::_computeSlots()
+{
+    GISMO_ASSERT( m_matrix.isCompressed(), "Expecting a compressed matrix.");
+    const gsMultiBasis<T> & mb = m_exprdata->multiBasis();
+    const size_t nr = m_vrow.size(), nc = m_vcol.size();
+
+    m_elOffset.resize(mb.nBases()+1);
+    m_elOffset.front() = 0;
+    for (size_t p = 0; p != mb.nBases(); ++p)
+        m_elOffset[p+1] = m_elOffset[p] + mb.basis(p).numElements();
+    m_slots.resize(m_elOffset.back() * nr * nc);
+
+    const index_t * outer = m_matrix.outerIndexPtr();
+    const index_t * inner = m_matrix.innerIndexPtr();
+    gsMatrix<T> pt;
+    gsMatrix<index_t> act;
+    std::vector<gsVector<index_t> > rInd(nr), cInd(nc);
+
+    for (size_t p = 0; p != mb.nBases(); ++p)
+    {
+        typename gsBasis<T>::domainIter domIt = mb.basis(p).makeDomainIterator();
+        for (; domIt->good(); domIt->next() )
+        {
+            pt = ( domIt->lowerCorner() + domIt->upperCorner() ) / 2;
+            for (size_t r = 0; r != nr; ++r)
+                _activeIndices(*m_vrow[r], p, pt, act, rInd[r]);
+            for (size_t c = 0; c != nc; ++c)
+                _activeIndices(*m_vcol[c], p, pt, act, cInd[c]);
+
+            const index_t el = m_elOffset[p] + domIt->id();
+            for (size_t r = 0; r != nr; ++r)
+                for (size_t c = 0; c != nc; ++c)
+                {
+                    gsMatrix<index_t> & sl = m_slots[(el*nr + r)*nc + c];
+                    sl.setConstant(rInd[r].size(), cInd[c].size(), -1);
+                    for (index_t j = 0; j != cInd[c].size(); ++j)
+                    {
+                        const index_t jj = cInd[c][j];
+                        if ( !m_vcol[c]->mapper.is_free_index(jj) ) continue;
+                        for (index_t i = 0; i != rInd[r].size(); ++i)
+                        {
+                            const index_t ii = rInd[r][i];
+                            if ( !m_vrow[r]->mapper.is_free_index(ii) ) continue;
+                            const index_t * pos =
+                                std::lower_bound(inner + outer[jj], inner + outer[jj+1], ii);
+                            GISMO_ASSERT( pos != inner + outer[jj+1] && *pos == ii,
+                                          "Entry ("<<ii<<","<<jj<<") is not in the pattern.");
+                            sl(i,j) = static_cast<index_t>(pos - inner);
+                        }
+                    }
+                }
+        }
+    }
+    m_patternNz = m_matrix.nonZeros();
+}
+
 template<class T> void gsExprAssembler<T>::resetDimensions()
 {
     if (!m_vcol.front()->valid()) m_vcol.front()->init();
@@ -733,11 +1297,27 @@ void gsExprAssembler<T>::assemble(const expr &... args)
 {
     GISMO_ASSERT(matrix().cols()==numDofs(), "System not initialized");
 
+    // Work items of consecutive elements, over all patches
+    const gsElementScheduler<T> sched(m_exprdata->multiBasis(),
+                                      m_options.askInt("ElementChunk", 0));
+    m_exprdata->setMapCache(m_options.askSwitch("CacheMaps", false) ?
+                            sched.numElements() : 0);
+    m_exprdata->initMapCache(std::make_tuple(args...));
+    m_profile.enable(m_options.askSwitch("Profile", false));
+
+#   ifdef _OPENMP
+    // Thread-local systems (for scatter::local)
+    const bool localScatter = (scatter::local == m_options.askInt("Scatter", scatter::critical));
+    std::vector<gsSparseMatrix<T> > lMatrix(localScatter ? omp_get_max_threads() : 0);
+    std::vector<gsMatrix<T> >       lRhs   (lMatrix.size());
+#   endif
+
 #pragma omp parallel
 {
 #   ifdef _OPENMP
     const int tid = omp_get_thread_num();
     const int nt  = omp_get_num_threads();
+    const bool lcl = localScatter && nt > 1 && m_slots.empty();
 #   endif
     auto arg_tpl = std::make_tuple(args...);
 
@@ -748,27 +1328,403 @@ void gsExprAssembler<T>::assemble(const expr &... args)
     typename gsQuadRule<T>::uPtr QuRule; // Quadrature rule
 
     gsVector<T> quWeights; // quadrature weights
+#   ifdef _OPENMP
+    if (lcl) _initLocal(lMatrix[tid], lRhs[tid]);
+    _eval ee(lcl ? lMatrix[tid] : m_matrix, lcl ? lRhs[tid] : m_rhs, quWeights, !lcl);
+#   else
     _eval ee(m_matrix, m_rhs, quWeights);
+#   endif
     const index_t elim = m_options.getInt("DirichletStrategy");
     ee.setElim(dirichlet::elimination==elim);
+    ee.setBatch(m_options.askSwitch("BatchQuadrature", false));
+    if ( !m_slots.empty() )
+        ee.setSlots(m_slots, m_vrow.size(), m_vcol.size());
+    ee.setProfile(m_profile);
+
+    typename gsBasis<T>::domainIter domIt;
+    index_t patchInd = -1;
+
+    // Note: omp threads fetch work items (ranges of consecutive
+    // elements of a patch) dynamically, from all patches
+#   pragma omp for schedule(dynamic,1)
+    for (index_t w = 0; w < sched.size(); ++w)
+    {
+        if ( sched.moveTo(w, domIt, patchInd) ) // new patch
+        {
+            QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(patchInd), m_options);
+            m_exprdata->getElement().set(*domIt,quWeights);
+        }
+
+        // Start iteration over the elements of the work item
+        for (index_t e = sched[w].first; e != sched[w].last; ++e, domIt->next() )
+        {
+            if ( nullptr!=m_elMask && !(*m_elMask)[sched.elementOffset(patchInd) + e] )
+                continue;
+            m_profile.tic();
+
+            // Map the Quadrature rule to the element
+            QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
+                           m_exprdata->points(), quWeights);
+            m_profile.toc(gsAssemblyProfile::quadrature,
+                          2.0 * m_exprdata->points().size(),
+                          (m_exprdata->points().size() + quWeights.size()) * sizeof(T));
 
-    // Note: omp thread will loop over all patches and will work on Ep/nt
-    // elements, where Ep is the elements on the patch.
-    for (unsigned patchInd = 0; patchInd < m_exprdata->multiBasis().nBases(); ++patchInd) //todo: distribute in parallel somehow?
+            if (m_exprdata->points().cols()==0)
+                continue;
+
+            // Perform required pre-computations on the quadrature nodes
+            m_exprdata->precompute(patchInd, boundary::none,
+                                   sched.elementOffset(patchInd) + e);
+            if ( m_profile.enabled() )
+                m_profile.toc(gsAssemblyProfile::precompute, 0,
+                              m_exprdata->numValues() * sizeof(T));
+
+            // Assemble contributions of the element
+            if ( !m_slots.empty() )
+                ee.setElement(sched.elementOffset(patchInd) + e);
+            op_tuple(ee, arg_tpl);
+        }
+    }
+
+#   ifdef _OPENMP
+    if (lcl) _mergeLocal(lMatrix, lRhs);
+#   endif
+
+}//omp parallel
+    _finalizeMatrix();
+}
+
+template<class T>
+template<class... expr>
+void gsExprAssembler<T>::assembleIncremental(const expr &... args)
+{
+    GISMO_ASSERT(matrix().cols()==numDofs(), "System not initialized");
+    typedef std::pair<index_t,index_t> hKey; // (level, tensor index)
+    const gsMultiBasis<T> & mb = m_exprdata->multiBasis();
+    const gsFeSpaceData<T> & sd = *m_vcol.front();
+
+    // A single space, discretized by the (hierarchical) integration elements
+    std::vector<std::vector<hKey> > keys(mb.nBases());
+    bool supported = 1==m_vrow.size() && 1==m_vcol.size() && m_vrow.front()==m_vcol.front()
+        && sd.fs==&mb && m_slots.empty() && 0==sd.mapper.firstIndex();
+    for (size_t p = 0; supported && p!=mb.nBases(); ++p)
+        supported = _hierarchicalKeys(mb.basis(p), keys[p]);
+    if (!supported)
     {
-        QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(patchInd), m_options);
+        m_incr.clear();
+        assemble(args...);
+        return;
+    }
 
-        // Initialize domain element iterator for current patch
-        typename gsBasis<T>::domainIter domIt =  // add patchInd to domainiter ?
-            m_exprdata->multiBasis().basis(patchInd).makeDomainIterator();
-        m_exprdata->getElement().set(*domIt,quWeights);
+    // The current content of the system is added at the end
+    gsSparseMatrix<T> base;
+    base.swap(m_matrix);
+    clearMatrix();
+    gsMatrix<T> baseRhs;
+    baseRhs.swap(m_rhs);
+    m_rhs.setZero(baseRhs.rows(), baseRhs.cols());
 
-        // Start iteration over elements of patchInd
-#       ifdef _OPENMP
-        for ( domIt->next(tid); domIt->good(); domIt->next(nt) )
-#       else
-        for (; domIt->good(); domIt->next() )
-#       endif
+    if ( m_incr.basis.nBases()==mb.nBases() && m_incr.rhs.cols()==m_rhs.cols() &&
+         m_incr.mapper.numComponents()==sd.mapper.numComponents() )
+    {
+        const gsDofMapper & map = sd.mapper, & omap = m_incr.mapper;
+        const index_t N = map.size();
+        std::vector<index_t> toOld(N, -2); // -1: no (unique) old DoF
+        std::vector<bool> changed(N, false);
+        std::vector<std::vector<index_t> > elDofs; // DoFs active on every element
+        elDofs.reserve(mb.totalElements());
+
+        typename gsBasis<T>::domainIter domIt;
+        gsMatrix<T> pt;
+        gsMatrix<index_t> act;
+        std::vector<hKey> okeys, ekeys;
+        for (size_t p = 0; p!=mb.nBases(); ++p)
+        {
+            const gsBasis<T> & b = mb.basis(p), & ob = m_incr.basis.basis(p);
+            _hierarchicalKeys(ob, okeys);
+            std::map<hKey,index_t> oldIndex;
+            for (size_t i = 0; i!=okeys.size(); ++i)
+                oldIndex[okeys[i]] = i;
+
+            // Old elements, identified by their corners
+            std::map<std::vector<T>,std::vector<hKey> > oldCells;
+            for (domIt = ob.makeDomainIterator(); domIt->good(); domIt->next())
+            {
+                std::vector<hKey> & k = oldCells[_cellKey(*domIt)];
+                pt = ( domIt->lowerCorner() + domIt->upperCorner() ) / 2;
+                ob.active_into(pt, act);
+                for (index_t i = 0; i != act.rows(); ++i)
+                    k.push_back(okeys[act.at(i)]);
+                std::sort(k.begin(), k.end());
+            }
+
+            // New-to-old map of the DoFs
+            for (index_t i = 0; i != b.size(); ++i)
+            {
+                typename std::map<hKey,index_t>::const_iterator it = oldIndex.find(keys[p][i]);
+                for (index_t c = 0; c != sd.dim; ++c)
+                {
+                    const index_t g = map.index(i, p, c);
+                    const index_t og = oldIndex.end()==it ? -1 : omap.index(it->second, p, c);
+                    toOld[g] = (-2==toOld[g] || og==toOld[g]) ? og : -1;
+                }
+            }
+
+            // Functions on new elements, or on elements whose active
+            // functions differ, are changed
+            for (domIt = b.makeDomainIterator(); domIt->good(); domIt->next())
+            {
+                pt = ( domIt->lowerCorner() + domIt->upperCorner() ) / 2;
+                b.active_into(pt, act);
+                ekeys.clear();
+                for (index_t i = 0; i != act.rows(); ++i)
+                    ekeys.push_back(keys[p][act.at(i)]);
+                std::sort(ekeys.begin(), ekeys.end());
+                typename std::map<std::vector<T>,std::vector<hKey> >::const_iterator
+                    it = oldCells.find(_cellKey(*domIt));
+                const bool refined = (oldCells.end()==it || it->second!=ekeys);
+
+                elDofs.push_back(std::vector<index_t>());
+                std::vector<index_t> & d = elDofs.back();
+                for (index_t c = 0; c != sd.dim; ++c)
+                    for (index_t i = 0; i != act.rows(); ++i)
+                    {
+                        d.push_back( map.index(act.at(i), p, c) );
+                        if (refined) changed[d.back()] = true;
+                    }
+            }
+        }
+
+        // DoFs without counterpart, or with a different fixed value
+        for (index_t g = 0; g != N; ++g)
+        {
+            const index_t og = toOld[g];
+            if ( og < 0 || map.is_free_index(g)!=omap.is_free_index(og) )
+                changed[g] = true;
+            else if ( map.is_boundary_index(g) &&
+                      (0!=sd.fixedDofs.size() || 0!=m_incr.fixedDofs.size()) )
+            {
+                const index_t bi = map.global_to_bindex(g), obi = omap.global_to_bindex(og);
+                changed[g] = changed[g] || bi >= sd.fixedDofs.rows() ||
+                    obi >= m_incr.fixedDofs.rows() ||
+                    sd.fixedDofs.row(bi) != m_incr.fixedDofs.row(obi);
+            }
+        }
+
+        // The rows and columns of the DoFs on elements touched by a
+        // changed function are re-integrated, on their supports
+        std::vector<bool> dirty(N, false), mask(elDofs.size(), false);
+        for (size_t e = 0; e != elDofs.size(); ++e)
+            for (size_t i = 0; i != elDofs[e].size(); ++i)
+                if ( changed[elDofs[e][i]] )
+                {
+                    for (size_t j = 0; j != elDofs[e].size(); ++j)
+                        dirty[elDofs[e][j]] = true;
+                    break;
+                }
+        for (size_t e = 0; e != elDofs.size(); ++e)
+            for (size_t i = 0; i != elDofs[e].size(); ++i)
+                if ( dirty[elDofs[e][i]] && map.is_free_index(elDofs[e][i]) )
+                {
+                    mask[e] = true;
+                    break;
+                }
+
+        m_elMask = &mask;
+        assemble(args...);
+        m_elMask = nullptr;
+
+        // Entries of re-integrated rows/columns, all others from the
+        // previous system
+        std::vector<index_t> toNew(omap.size(), -1);
+        for (index_t g = 0; g != N; ++g)
+            if ( !dirty[g] && toOld[g] >= 0 )
+                toNew[toOld[g]] = g;
+
+        gsSparseEntries<T> entries;
+        entries.reserve(m_matrix.nonZeros() + m_incr.matrix.nonZeros());
+        for (index_t k = 0; k != m_matrix.outerSize(); ++k)
+            for (typename gsSparseMatrix<T>::InnerIterator it(m_matrix, k); it; ++it)
+                if ( dirty[it.row()] || dirty[it.col()] )
+                    entries.add(it.row(), it.col(), it.value());
+        for (index_t k = 0; k != m_incr.matrix.outerSize(); ++k)
+            for (typename gsSparseMatrix<T>::InnerIterator it(m_incr.matrix, k); it; ++it)
+                if ( -1 != toNew[it.row()] && -1 != toNew[it.col()] )
+                    entries.add(toNew[it.row()], toNew[it.col()], it.value());
+        m_matrix.setFrom(entries);
+        m_matrix.makeCompressed();
+
+        for (index_t r = 0; r != m_rhs.rows(); ++r)
+            if ( !dirty[r] && toOld[r] >= 0 )
+                m_rhs.row(r) = m_incr.rhs.row(toOld[r]);
+    }
+    else
+        assemble(args...);
+
+    m_incr.basis     = mb;
+    m_incr.mapper    = sd.mapper;
+    m_incr.fixedDofs = sd.fixedDofs;
+    m_incr.matrix    = m_matrix;
+    m_incr.rhs       = m_rhs;
+
+    if ( 0 != base.nonZeros() )
+    {
+        m_matrix += base;
+        m_matrix.makeCompressed();
+    }
+    if ( baseRhs.size() == m_rhs.size() )
+        m_rhs += baseRhs;
+}
+
+template<class T>
+template<class E1, class E2>
+void gsExprAssembler<T>::collocate(const expr::_expr<E1> & lhs,
+                                   const expr::_expr<E2> & rhs)
+{
+    GISMO_ASSERT(matrix().cols()==numDofs(), "System not initialized");
+    GISMO_ASSERT(numTestDofs()==numDofs(), "Expecting equally many equations and unknowns");
+    const expr::gsFeSpace<T> & u = lhs.rowVar();
+    GISMO_ASSERT(1==u.dim(), "Collocation is implemented for scalar spaces.");
+    const gsDofMapper & map = u.mapper();
+    const gsFunctionSet<T> & src = u.source();
+    const bool elim = (dirichlet::elimination == m_options.getInt("DirichletStrategy"));
+
+    // Collocation points (patch, basis function): the anchors of the
+    // free DoFs, a DoF shared by patches is collocated only once
+    std::vector<gsMatrix<T> > anchors(src.nPieces());
+    std::vector<std::pair<index_t,index_t> > pts;
+    std::vector<bool> done(numDofs(), false);
+    for (index_t p = 0; p != src.nPieces(); ++p)
+    {
+        const gsBasis<T> & b = dynamic_cast<const gsBasis<T>&>(src.piece(p));
+        anchors[p] = b.anchors();
+        for (index_t i = 0; i != b.size(); ++i)
+        {
+            const index_t ii = map.index(i, p);
+            if ( map.is_free_index(ii) && !done[ii] )
+            {
+                done[ii] = true;
+                pts.push_back(std::make_pair(p, i));
+            }
+        }
+    }
+
+    // Work items: ranges of consecutive points of a patch
+    const index_t chunk = 64;
+    std::vector<index_t> items(1, 0);
+    for (size_t k = 1; k <= pts.size(); ++k)
+        if ( k == pts.size() || pts[k].first != pts[k-1].first ||
+             static_cast<index_t>(k) - items.back() == chunk )
+            items.push_back(k);
+
+    // The rows are distinct, but an entry of a sparse matrix can not
+    // be inserted concurrently: every thread collects its entries
+#   ifdef _OPENMP
+    std::vector<gsSparseEntries<T> > lEntries(omp_get_max_threads());
+#   else
+    std::vector<gsSparseEntries<T> > lEntries(1);
+#   endif
+
+#pragma omp parallel
+{
+#   ifdef _OPENMP
+    gsSparseEntries<T> & entries = lEntries[omp_get_thread_num()];
+#   else
+    gsSparseEntries<T> & entries = lEntries.front();
+#   endif
+
+    // Thread copies, referring to the data of this thread
+    const E1 l = static_cast<const E1&>(lhs);
+    const auto r = rhs.val();
+    m_exprdata->parse(l, r);
+    const expr::gsFeSpace<T> & v = l.rowVar();
+    gsMatrix<T> lv;
+
+#   pragma omp for schedule(dynamic,1)
+    for (index_t w = 0; w < static_cast<index_t>(items.size()) - 1; ++w)
+    {
+        const index_t first = items[w], n = items[w+1] - first;
+        const index_t patch = pts[first].first;
+
+        // Evaluate all points of the item at once
+        gsMatrix<T> & pt = m_exprdata->points();
+        pt.resize(anchors[patch].rows(), n);
+        for (index_t k = 0; k != n; ++k)
+            pt.col(k) = anchors[patch].col(pts[first+k].second);
+        m_exprdata->precompute(patch);
+
+        const gsMatrix<index_t> & act = v.data().actives;
+        for (index_t k = 0; k != n; ++k)
+        {
+            const index_t row = map.index(pts[first+k].second, patch);
+            lv = l.eval(k);
+            for (index_t j = 0; j != act.rows(); ++j)
+            {
+                const index_t jj = map.index(act(j, 1==act.cols() ? 0 : k), patch);
+                if ( map.is_free_index(jj) )
+                    entries.add(row, jj, lv.at(j));
+                else if (elim)
+                    m_rhs.row(row).array() -=
+                        lv.at(j) * u.fixedPart().row(map.global_to_bindex(jj)).array();
+            }
+            m_rhs.row(row).array() += r.eval(k);
+        }
+    }
+}//omp parallel
+
+    for (size_t t = 1; t < lEntries.size(); ++t)
+        lEntries.front().insert(lEntries.front().end(), lEntries[t].begin(), lEntries[t].end());
+    gsSparseMatrix<T> C(m_matrix.rows(), m_matrix.cols());
+    C.setFrom(lEntries.front());
+    if ( 0 == m_matrix.nonZeros() )
+        m_matrix.swap(C);
+    else
+        m_matrix += C;
+    _finalizeMatrix();
+}
+
+template<class T>
+template<class... expr>
+void gsExprAssembler<T>::matrixFreeApply(const gsMatrix<T> & x, gsMatrix<T> & y,
+                                         const expr &... args)
+{
+    GISMO_ASSERT(x.rows()==numDofs(), "Invalid size of the input vector");
+    y.setZero(numTestDofs(), x.cols());
+
+    // Work items of consecutive elements, over all patches
+    const gsElementScheduler<T> sched(m_exprdata->multiBasis(),
+                                      m_options.askInt("ElementChunk", 0));
+    m_exprdata->setMapCache(m_options.askSwitch("CacheMaps", false) ?
+                            sched.numElements() : 0);
+    m_exprdata->initMapCache(std::make_tuple(args...));
+
+#pragma omp parallel
+{
+    auto arg_tpl = std::make_tuple(args...);
+
+    m_exprdata->parse(arg_tpl);
+    m_exprdata->activateFlags(SAME_ELEMENT);
+
+    typename gsQuadRule<T>::uPtr QuRule; // Quadrature rule
+
+    gsVector<T> quWeights; // quadrature weights
+    gsMatrix<T> ly = gsMatrix<T>::Zero(y.rows(), y.cols()); // thread-local result
+    _evalApply ee(x, ly, quWeights, m_options.askSwitch("BatchQuadrature", false));
+
+    typename gsBasis<T>::domainIter domIt;
+    index_t patchInd = -1;
+
+#   pragma omp for schedule(dynamic,1)
+    for (index_t w = 0; w < sched.size(); ++w)
+    {
+        if ( sched.moveTo(w, domIt, patchInd) ) // new patch
+        {
+            QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(patchInd), m_options);
+            m_exprdata->getElement().set(*domIt,quWeights);
+        }
+
+        // Start iteration over the elements of the work item
+        for (index_t e = sched[w].first; e != sched[w].last; ++e, domIt->next() )
         {
             // Map the Quadrature rule to the element
             QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
@@ -778,16 +1734,18 @@ void gsExprAssembler<T>::assemble(const expr &... args)
                 continue;
 
             // Perform required pre-computations on the quadrature nodes
-            m_exprdata->precompute(patchInd);
-            //m_exprdata->precompute(patchInd, QuRule, *domIt); // todo
+            m_exprdata->precompute(patchInd, boundary::none,
+                                   sched.elementOffset(patchInd) + e);
 
-            // Assemble contributions of the element
+            // Apply the element matrices
             op_tuple(ee, arg_tpl);
         }
     }
 
+#   pragma omp critical (matrixFreeApply)
+    y += ly;
+
 }//omp parallel
-    m_matrix.makeCompressed();
 }
 
 template<class T>
@@ -797,14 +1755,28 @@ void gsExprAssembler<T>::assembleBdr(const bcRefList & BCs, expr&... args)
     GISMO_ASSERT(matrix().cols()==numDofs(), "System not initialized");
 
     if ( BCs.empty() || 0==numDofs() ) return;
-    m_exprdata->setMutSource(*BCs.front().get().function()); //initialize once
-
-// #pragma omp parallel
-// {
-// #   ifdef _OPENMP
-//     const int tid = omp_get_thread_num();
-//     const int nt  = omp_get_num_threads();
-// #   endif
+
+    // Random access to the conditions, for the parallel loop
+    std::vector<const boundary_condition<T>*> bcs;
+    bcs.reserve(BCs.size());
+    for (typename bcRefList::const_iterator iit = BCs.begin(); iit!= BCs.end(); ++iit)
+        bcs.push_back(&iit->get());
+
+#   ifdef _OPENMP
+    // Thread-local systems (for scatter::local)
+    const bool localScatter = (scatter::local == m_options.askInt("Scatter", scatter::critical));
+    std::vector<gsSparseMatrix<T> > lMatrix(localScatter ? omp_get_max_threads() : 0);
+    std::vector<gsMatrix<T> >       lRhs   (lMatrix.size());
+#   endif
+
+#pragma omp parallel
+{
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+    const bool lcl = localScatter && nt > 1;
+#   endif
+    m_exprdata->setMutSource(*bcs.front()->function()); //initialize once
     auto arg_tpl = std::make_tuple(args...);
     m_exprdata->parse(arg_tpl);
     m_exprdata->activateFlags(SAME_ELEMENT);
@@ -812,12 +1784,19 @@ void gsExprAssembler<T>::assembleBdr(const bcRefList & BCs, expr&... args)
     typename gsQuadRule<T>::uPtr QuRule; // Quadrature rule
     gsVector<T> quWeights;               // quadrature weights
 
+#   ifdef _OPENMP
+    if (lcl) _initLocal(lMatrix[tid], lRhs[tid]);
+    _eval ee(lcl ? lMatrix[tid] : m_matrix, lcl ? lRhs[tid] : m_rhs, quWeights, !lcl);
+#   else
     _eval ee(m_matrix, m_rhs, quWeights);
+#   endif
 
-//#   pragma omp parallel for
-    for (typename bcRefList::const_iterator iit = BCs.begin(); iit!= BCs.end(); ++iit)
+    // Note: the sides are distributed dynamically, since they have
+    // very different numbers of elements
+#   pragma omp for schedule(dynamic,1)
+    for (index_t i = 0; i < static_cast<index_t>(bcs.size()); ++i)
     {
-        const boundary_condition<T> * it = &iit->get();
+        const boundary_condition<T> * it = bcs[i];
 
         QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(it->patch()), m_options, it->side().direction());
 
@@ -847,9 +1826,12 @@ void gsExprAssembler<T>::assembleBdr(const bcRefList & BCs, expr&... args)
         }
     }
 
-//}//omp parallel
+#   ifdef _OPENMP
+    if (lcl) _mergeLocal(lMatrix, lRhs);
+#   endif
 
-    m_matrix.makeCompressed();
+}//omp parallel
+    _finalizeMatrix();
 }
 
 template<class T> template<class... expr>
@@ -857,8 +1839,20 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
 {
     GISMO_ASSERT(matrix().cols()==numDofs(), "System not initialized");
 
+#   ifdef _OPENMP
+    // Thread-local systems (for scatter::local)
+    const bool localScatter = (scatter::local == m_options.askInt("Scatter", scatter::critical));
+    std::vector<gsSparseMatrix<T> > lMatrix(localScatter ? omp_get_max_threads() : 0);
+    std::vector<gsMatrix<T> >       lRhs   (lMatrix.size());
+#   endif
+
 #pragma omp parallel
 {
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+    const bool lcl = localScatter && nt > 1;
+#   endif
     typedef typename gsFunction<T>::uPtr ifacemap;
 
     auto arg_tpl = std::make_tuple(args...);
@@ -868,14 +1862,21 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
 
     typename gsQuadRule<T>::uPtr QuRule;
     gsVector<T> quWeights;// quadrature weights
+#   ifdef _OPENMP
+    if (lcl) _initLocal(lMatrix[tid], lRhs[tid]);
+    _eval ee(lcl ? lMatrix[tid] : m_matrix, lcl ? lRhs[tid] : m_rhs, quWeights, !lcl);
+#   else
     _eval ee(m_matrix, m_rhs, quWeights);
+#   endif
 
     const bool flipSide = m_options.askSwitch("flipSide", false);
 
     ifacemap interfaceMap;
-#   pragma omp for
+    // Note: interfaces are distributed dynamically, since they have
+    // very different numbers of elements
+#   pragma omp for schedule(dynamic,1)
     for (gsBoxTopology::const_iiterator it = iFaces.begin();
-         it != iFaces.end(); ++it )
+         it < iFaces.end(); ++it )
     {
         // If flipSide switch is enabled, then the integration will be
         // performed on the opposite side of the interface
@@ -921,8 +1922,12 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
         }
     }
 
+#   ifdef _OPENMP
+    if (lcl) _mergeLocal(lMatrix, lRhs);
+#   endif
+
 }//omp parallel
-    m_matrix.makeCompressed();
+    _finalizeMatrix();
 }
 
 template<class T> template<class expr>
@@ -934,14 +1939,35 @@ void gsExprAssembler<T>::assembleJacobian(const expr residual, solution & u)
     clearMatrix();
     clearRhs();
 
+    // Work items of consecutive elements, over all patches
+    const gsElementScheduler<T> sched(m_exprdata->multiBasis(),
+                                      m_options.askInt("ElementChunk", 0));
+
+    // The finite differences perturb the coefficients of u. The work
+    // items of one color have no coefficient in common, so they are
+    // computed concurrently, one color after the other.
+    std::vector<std::vector<index_t> > colors;
+    _colorItems(sched, u.space(), colors);
+
+#   ifdef _OPENMP
+    // Thread-local systems (for scatter::local)
+    const bool localScatter = (scatter::local == m_options.askInt("Scatter", scatter::critical));
+    std::vector<gsSparseMatrix<T> > lMatrix(localScatter ? omp_get_max_threads() : 0);
+    std::vector<gsMatrix<T> >       lRhs   (lMatrix.size());
+#   endif
+
 #pragma omp parallel
 {
 #   ifdef _OPENMP
     const int tid = omp_get_thread_num();
     const int nt  = omp_get_num_threads();
+    const bool lcl = localScatter && nt > 1 && m_slots.empty();
 #   endif
-
-    m_exprdata->parse(residual, u);
+    // Thread-local copies, the expressions are bound to the
+    // evaluation data of the thread and hold their own buffers
+    const expr res = residual;
+    solution   sol = u;
+    m_exprdata->parse(res, sol);
     m_exprdata->activateFlags(SAME_ELEMENT);
     //op_tuple(__printExpr(), arg_tpl);
 
@@ -949,46 +1975,61 @@ void gsExprAssembler<T>::assembleJacobian(const expr residual, solution & u)
 
     gsVector<T> quWeights; // quadrature weights
 
+#   ifdef _OPENMP
+    if (lcl) _initLocal(lMatrix[tid], lRhs[tid]);
+    _eval ee(lcl ? lMatrix[tid] : m_matrix, lcl ? lRhs[tid] : m_rhs, quWeights, !lcl);
+#   else
     _eval ee(m_matrix, m_rhs, quWeights);
+#   endif
+    if ( !m_slots.empty() )
+        ee.setSlots(m_slots, m_vrow.size(), m_vcol.size());
 
-    // Note: omp thread will loop over all patches and will work on Ep/nt
-    // elements, where Ep is the elements on the patch.
-    for (unsigned patchInd = 0; patchInd < m_exprdata->multiBasis().nBases(); ++patchInd)
-    {
-        QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(patchInd), m_options);
+    typename gsBasis<T>::domainIter domIt;
+    index_t patchInd = -1;
 
-        // Initialize domain element iterator for current patch
-        typename gsBasis<T>::domainIter domIt =  // add patchInd to domainiter ?
-            m_exprdata->multiBasis().basis(patchInd).makeDomainIterator();
-        m_exprdata->getElement().set(*domIt,quWeights);
+    for (size_t c = 0; c != colors.size(); ++c)
+    {
+        const std::vector<index_t> & items = colors[c];
 
-        // Start iteration over elements of patchInd
-#       ifdef _OPENMP
-        for ( domIt->next(tid); domIt->good(); domIt->next(nt) )
-#       else
-        for (; domIt->good(); domIt->next() )
-#       endif
+        // Note: omp threads fetch the work items of the color
+        // dynamically, the implicit barrier separates the colors
+#       pragma omp for schedule(dynamic,1)
+        for (index_t i = 0; i < static_cast<index_t>(items.size()); ++i)
         {
-            // Map the Quadrature rule to the element
-            QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
-                           m_exprdata->points(), quWeights);
+            const index_t w = items[i];
+            if ( sched.moveTo(w, domIt, patchInd) ) // new patch
+            {
+                QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(patchInd), m_options);
+                m_exprdata->getElement().set(*domIt,quWeights);
+            }
 
-            if (m_exprdata->points().cols()==0)
-                continue;
+            // Start iteration over the elements of the work item
+            for (index_t e = sched[w].first; e != sched[w].last; ++e, domIt->next() )
+            {
+                // Map the Quadrature rule to the element
+                QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
+                               m_exprdata->points(), quWeights);
 
-            // Evaluate at quadrature points
-            m_exprdata->precompute(patchInd);
+                if (m_exprdata->points().cols()==0)
+                    continue;
+
+                // Evaluate at quadrature points
+                m_exprdata->precompute(patchInd);
 
-#           pragma omp critical (assemble_fdiffs)
-            {
                 // ee(residual); //Computes residual to m_rhs
-                ee.diff(residual, u); //Computes Jacobian
+                if ( !m_slots.empty() )
+                    ee.setElement(sched.elementOffset(patchInd) + e);
+                ee.diff(res, sol); //Computes Jacobian
             }
         }
     }
 
+#   ifdef _OPENMP
+    if (lcl) _mergeLocal(lMatrix, lRhs);
+#   endif
+
 }//omp parallel
-    m_matrix.makeCompressed();
+    _finalizeMatrix();
 }
 
 
@@ -1115,7 +2156,7 @@ void gsExprAssembler<T>::assembleJacobianIfc(const ifContainer & iFaces,
         }
     }
 
-    m_matrix.makeCompressed();
+    _finalizeMatrix();
 }
 
 
@@ -16,6 +16,8 @@
 // #include<gsIO/gsParaviewCollection.h>
 #include<fstream>
 #include<gsAssembler/gsQuadrature.h>
+#include<gsAssembler/gsElementScheduler.h>
+#include <gsAssembler/gsAssemblyProfile.h>
 #include <gsAssembler/gsRemapInterface.h>
 #include <gsAssembler/gsCPPInterface.h>
 
@@ -40,6 +42,8 @@ private:
 
     gsOptionList m_options;
 
+    gsAssemblyProfile m_profile;
+
 public:
     typedef typename gsBoundaryConditions<T>::bcRefList   bcRefList;
 
@@ -73,12 +77,22 @@ public:
         opt.addInt ("plot.npts", "Number of sampling points for plotting", 3000 );
         opt.addSwitch("plot.elements", "Include the element mesh in plot (when applicable)", false);
         opt.addSwitch("flipSide", "Flip side of interface where evaluation is performed.", false);
+        opt.addInt ("ElementChunk", "Number of consecutive elements per work item in parallel evaluation (0: automatic)", 0);
+        opt.addSwitch("Profile", "Record the time spent in the phases of integrals over the domain, per thread (see profile())", false);
         //opt.addSwitch("plot.cnet", "Include the control net in plot (when applicable)", false);
         return opt;
     }
 
     gsOptionList & options() {return m_options;}
 
+    /// \brief Returns the timings of the phases of the integrals
+    /// over the domain (integral, max, min,...), recorded if the
+    /// option "Profile" is set.
+    const gsAssemblyProfile & profile() const { return m_profile; }
+
+    /// Resets the counters of profile()
+    void resetProfile() { m_profile.reset(m_profile.enabled()); }
+
 public:
 
     /// Returns the last computed value
@@ -269,6 +283,22 @@ public:
     eval(const expr::_expr<E> & testExpr, const gsVector<T> & pt,
          const index_t patchInd = 0);
 
+    /// \brief Computes the values of the expression \a expr at many
+    /// points: column \a i of \a pts is a parametric point of patch
+    /// \a patchInd[i].
+    ///
+    /// Column \a i of the result contains the value of \a expr at
+    /// point \a i (column-wise, if \a expr is matrix-valued). The
+    /// points are grouped by patch and, if the integration elements
+    /// are set, by element; the groups are evaluated in parallel, with
+    /// one evaluation of the bases and maps per group. The points of
+    /// one element share the active functions, assuming that the
+    /// functions in \a expr are discretized on (coarsenings of) the
+    /// integration elements, as in assembly.
+    template<class E>
+    gsMatrix<T> evalBatch(const expr::_expr<E> & expr, const gsMatrix<T> & pts,
+                          const gsVector<index_t> & patchInd);
+
     template<class E>
 #ifdef __DOXYGEN__
     gsAsConstMatrix<T>
@@ -348,6 +378,11 @@ private:
     template<class E>
     void computeGrid_impl(const expr::_expr<E> & expr, const index_t patchInd);
 
+    static void _copyTo(const T v, gsMatrix<T> & m) { m.resize(1,1); m(0,0) = v; }
+
+    template<class M>
+    static void _copyTo(const M & v, gsMatrix<T> & m) { m = v; }
+
     struct plus_op
     {
         static inline T init() { return 0; }
@@ -358,7 +393,7 @@ private:
     {
         static inline T init() { return math::limits::max(); }
         static inline void acc (const T contrib, const T, T & res)
-        { res = math::min(contrib, res); } //note: min/max are not atomic
+        { res = math::min(contrib, res); }
     };
     struct max_op
     {
@@ -378,14 +413,18 @@ T gsExprEvaluator<T>::compute_impl(const expr::_expr<E> & expr)
     if ( storeElWise )
         m_elWise.resize(m_exprdata->multiBasis().totalElements());
 
+    // Work items of consecutive elements, over all patches
+    const gsElementScheduler<T> sched(m_exprdata->multiBasis(),
+                                      m_options.askInt("ElementChunk", 0));
+    m_profile.enable(m_options.askSwitch("Profile", false));
+
+    // Partial values of the work items. They are combined in a fixed
+    // order, so that the result does not depend on which thread
+    // computed an item
+    std::vector<T> partial(sched.size(), _op::init());
+
 #pragma omp parallel
 {
-#   ifdef _OPENMP
-    const int tid = omp_get_thread_num();
-    const int nt  = omp_get_num_threads();
-    index_t patch_cnt = 0;
-#   endif
-
     gsQuadRule<T> QuRule;  // Quadrature rule
     gsVector<T> quWeights; // quadrature weights
 
@@ -395,57 +434,65 @@ T gsExprEvaluator<T>::compute_impl(const expr::_expr<E> & expr)
     
     // Computed value on element
     T elVal;
-    index_t c = 0;
-    for (unsigned patchInd=0; patchInd < m_exprdata->multiBasis().nBases(); ++patchInd)
-    {
-        // Quadrature rule
-        QuRule =  gsQuadrature::get(m_exprdata->multiBasis().basis(patchInd), m_options);
+    typename gsBasis<T>::domainIter domIt;
+    index_t patchInd = -1;
 
-        // Initialize domain element iterator
-        typename gsBasis<T>::domainIter domIt =
-            m_exprdata->multiBasis().piece(patchInd).makeDomainIterator();
-        m_exprdata->getElement().set(*domIt,quWeights);
-
-        // Start iteration over elements of patchInd
-#       ifdef _OPENMP
-        if ( storeElWise )
+#   pragma omp for schedule(dynamic,1)
+    for (index_t w = 0; w < sched.size(); ++w)
+    {
+        if ( sched.moveTo(w, domIt, patchInd) ) // new patch
         {
-            c = patch_cnt + tid;
-            patch_cnt += domIt->numElements();// a bit costy
+            // Quadrature rule
+            QuRule =  gsQuadrature::get(m_exprdata->multiBasis().basis(patchInd), m_options);
+            m_exprdata->getElement().set(*domIt,quWeights);
         }
-        for ( domIt->next(tid); domIt->good(); domIt->next(nt) )
-#       else
-        for (; domIt->good(); domIt->next() )
-#       endif
+
+        // Start iteration over the elements of the work item
+        T itemVal = _op::init();
+        for (index_t e = sched[w].first; e != sched[w].last; ++e, domIt->next() )
         {
+            m_profile.tic();
+
             // Map the Quadrature rule to the element
             QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(),
                           m_exprdata->points(), quWeights);
+            m_profile.toc(gsAssemblyProfile::quadrature,
+                          2.0 * m_exprdata->points().size(),
+                          (m_exprdata->points().size() + quWeights.size()) * sizeof(T));
 
             // Perform required pre-computations on the quadrature nodes
             m_exprdata->precompute(patchInd);
+            if ( m_profile.enabled() )
+                m_profile.toc(gsAssemblyProfile::precompute, 0,
+                              m_exprdata->numValues() * sizeof(T));
 
             // Compute on element
             elVal = _op::init();
             for (index_t k = 0; k != quWeights.rows(); ++k) // loop over quad. nodes
                 _op::acc(_arg.eval(k), quWeights[k], elVal);
+            m_profile.toc(gsAssemblyProfile::evaluate, 2.0 * quWeights.size(), sizeof(T));
 
             if ( storeElWise )
-            {
-#               ifdef _OPENMP
-                m_elWise[c] = elVal;
-                c += nt;
-#               else
-                m_elWise[c++] = elVal;
-#               endif
-            }
+                m_elWise[sched.elementOffset(patchInd) + e] = elVal;
 
-#           pragma omp critical (_op_acc)
-            _op::acc(elVal, 1, m_value);
+            _op::acc(elVal, 1, itemVal);
+            m_profile.toc(gsAssemblyProfile::push, 1);
         }
+        partial[w] = itemVal;
+    }
+
+    // Pairwise (tree) reduction of the partial values
+    for (index_t s = 1; s < sched.size(); s *= 2)
+    {
+#       pragma omp for schedule(static)
+        for (index_t w = 0; w < sched.size() - s; w += 2*s)
+            _op::acc(partial[w+s], 1, partial[w]);
     }
 
 }//omp parallel
+
+    if ( !partial.empty() )
+        _op::acc(partial.front(), 1, m_value);
     return m_value;
 }
 
@@ -703,6 +750,102 @@ gsExprEvaluator<T>::eval(const expr::_expr<E> & expr,
 }
 
 
+template<class T>
+template<class E>
+gsMatrix<T> gsExprEvaluator<T>::evalBatch(const expr::_expr<E> & expr,
+                                          const gsMatrix<T> & pts,
+                                          const gsVector<index_t> & patchInd)
+{
+    GISMO_ASSERT(pts.cols()==patchInd.size(), "Expecting one patch index per point.");
+    const index_t np = pts.cols();
+    gsMatrix<T> result;
+    if (0==np) return result;
+    const bool mesh = m_exprdata->multiBasisSet();
+    const index_t maxGroup = 256; // bounds the size of the evaluation data
+
+    // Sort the points by patch and element; the element of a point is
+    // identified by (a hash of) its active functions on the mesh
+    typedef std::pair<std::pair<index_t,size_t>,index_t> pointKey;
+    std::vector<pointKey> order(np);
+#   pragma omp parallel
+    {
+        gsMatrix<index_t> act;
+#       pragma omp for
+        for (index_t i = 0; i < np; ++i)
+        {
+            size_t h = 0;
+            if (mesh)
+            {
+                m_exprdata->multiBasis().basis(patchInd[i]).active_into(pts.col(i), act);
+                for (index_t j = 0; j != act.size(); ++j)
+                    h = (h ^ static_cast<size_t>(act.at(j))) * 1099511628211u;
+            }
+            order[i] = pointKey(std::make_pair(patchInd[i], h), i);
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<index_t> group(1, 0);
+    for (index_t i = 1; i != np; ++i)
+        if ( order[i].first != order[i-1].first || i - group.back() == maxGroup )
+            group.push_back(i);
+    group.push_back(np);
+
+    // The size of the values
+    {
+        const E ee = static_cast<const E&>(expr);
+        m_exprdata->parse(ee);
+        m_exprdata->points() = pts.col(order.front().second);
+        m_exprdata->precompute(order.front().first.first);
+        gsMatrix<T> tmp;
+        _copyTo(ee.eval(0), tmp);
+        result.resize(tmp.size(), np);
+    }
+
+#   pragma omp parallel
+    {
+        const E ee = static_cast<const E&>(expr);
+        m_exprdata->parse(ee);
+        gsMatrix<T> tmp;
+        gsMatrix<index_t> act;
+
+#       pragma omp for schedule(dynamic,1)
+        for (index_t g = 0; g < static_cast<index_t>(group.size()) - 1; ++g)
+        {
+            const index_t first = group[g], n = group[g+1] - first;
+            const index_t patch = order[first].first.first;
+            gsMatrix<T> & pt = m_exprdata->points();
+            pt.resize(pts.rows(), n);
+            for (index_t k = 0; k != n; ++k)
+                pt.col(k) = pts.col(order[first+k].second);
+
+            // The active functions are computed once if all points lie
+            // in the same element
+            bool same = mesh;
+            if (mesh)
+            {
+                m_exprdata->multiBasis().basis(patch).active_into(pt, act);
+                for (index_t k = 1; same && k != n; ++k)
+                    same = (act.col(k) == act.col(0));
+            }
+            if (same)
+                m_exprdata->activateFlags(SAME_ELEMENT);
+            else
+                m_exprdata->deactivateFlags(SAME_ELEMENT);
+
+            m_exprdata->precompute(patch);
+            for (index_t k = 0; k != n; ++k)
+            {
+                _copyTo(ee.eval(k), tmp);
+                GISMO_ASSERT(tmp.size()==result.rows(), "The size of the expression varies.");
+                result.col(order[first+k].second) = gsAsConstVector<T>(tmp.data(), tmp.size());
+            }
+        }
+    }//omp parallel
+
+    return result;
+}
+
 template<class T>
 template<class E>
 typename util::enable_if<E::ScalarValued,gsAsConstMatrix<T> >::type
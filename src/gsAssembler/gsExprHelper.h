@@ -28,13 +28,13 @@ class gsExprHelper
 private:
     gsExprHelper(const gsExprHelper &);
 
-    gsExprHelper() : m_mirror(nullptr), mesh_ptr(nullptr),
-                     mutSrc(nullptr), mutMap(nullptr)
+    gsExprHelper() : m_mcacheSize(0), m_mirror(nullptr), mesh_ptr(nullptr),
+                     mutMap(nullptr)
     { }
 
     explicit gsExprHelper(gsExprHelper * m)
-    : m_mirror(memory::make_shared_not_owned(m)),
-      mesh_ptr(m->mesh_ptr), mutSrc(nullptr), mutMap(nullptr)
+    : m_mcacheSize(0), m_mirror(memory::make_shared_not_owned(m)),
+      mesh_ptr(m->mesh_ptr), mutMap(nullptr)
     { }
 
 private:
@@ -44,6 +44,7 @@ private:
     typedef std::map<const gsFunctionSet<T>*,thMapData>  MapData;
     typedef std::pair<const gsFunctionSet<T>*,thMapData*> CFuncKey;
     typedef std::map<CFuncKey,thFuncData>  CFuncData;
+    typedef std::map<const gsFunctionSet<T>*,std::vector<gsMapData<T> > > MapCache;
 
     typedef typename FuncData::iterator FuncDataIt;
     typedef typename MapData ::iterator MapDataIt;
@@ -54,13 +55,16 @@ private:
     MapData   m_mdata;///< maps
     CFuncData m_cdata;///< compositions
 
+    MapCache  m_mcache;///< cached map data per element
+    index_t   m_mcacheSize;
+
     memory::shared_ptr<gsExprHelper> m_mirror;
 
     const gsMultiBasis<T> * mesh_ptr;
 
     // mutable pair of variable and data,
     // ie. not uniquely assigned to a gsFunctionSet
-    const gsFunctionSet<T> * mutSrc;
+    util::gsThreaded<const gsFunctionSet<T>*> mutSrc; // per thread, eg. for boundary loops
     const gsFunctionSet<T> * mutMap;
     thFuncData               mutData;
 
@@ -117,6 +121,41 @@ public:
         }//implicit barrier
     }
 
+    /// \brief Enables caching of the geometry map data on \a
+    /// numElements elements (zero disables it).
+    ///
+    /// The map data of an element is stored at the first call of
+    /// precompute(patchIndex,bs,elementId) and reused on subsequent
+    /// calls, until clearMapCache() is called.
+    void setMapCache(const index_t numElements)
+    {
+        if (numElements!=m_mcacheSize)
+            clearMapCache();
+        m_mcacheSize = numElements;
+    }
+
+    /// Discards the cached map data, eg. after the geometry or the
+    /// quadrature rule have changed
+    void clearMapCache() { m_mcache.clear(); }
+
+    /// \brief Allocates the cache entries of the maps appearing in
+    /// the expressions \a tuple (see setMapCache).
+    ///
+    /// \warning To be called before the parallel region, in which the
+    /// threads only look up the entries
+    template<class... Ts>
+    void initMapCache(const std::tuple<Ts...> & tuple)
+    {
+        if (0==m_mcacheSize) return;
+        parse(tuple);
+        for (MapDataIt it  = m_mdata.begin(); it != m_mdata.end(); ++it)
+        {
+            std::vector<gsMapData<T> > & c = m_mcache[it->first];
+            if ( static_cast<index_t>(c.size())!=m_mcacheSize )
+                c.resize(m_mcacheSize);
+        }
+    }
+
     void setMultiBasis(const gsMultiBasis<T> & mesh) { mesh_ptr = &mesh; }
 
     bool multiBasisSet() { return NULL!=mesh_ptr;}
@@ -195,9 +234,10 @@ public:
         return var;
     }
 
+    /// Sets the source of the mutable variable for the calling thread
     void setMutSource(const gsFunctionSet<T> & func)
     {
-        mutSrc = &func;
+        mutSrc.mine() = &func;
     }
 
     //void clearMutSource() ?
@@ -216,12 +256,26 @@ public:
         // gsInfo<< "-cdata: "<< m_cdata.size()<<std::endl;
     }
 
+    void deactivateFlags(unsigned flg)
+    {
+        for (MapDataIt it  = m_mdata.begin(); it != m_mdata.end(); ++it)
+            it->second.mine().flags &= ~flg;
+        for (FuncDataIt it = m_fdata.begin(); it != m_fdata.end(); ++it)
+            it->second.mine().flags &= ~flg;
+        for (CFuncDataIt it  = m_cdata.begin(); it != m_cdata.end(); ++it)
+            it->second.mine().flags &= ~flg;
+    }
+
 private:
 
     inline gsExprHelper & iface()
     {
         if (nullptr==m_mirror )
-            m_mirror = memory::make_shared(new gsExprHelper(this));
+        {
+#           pragma omp critical (m_mirror_first_touch)
+            if (nullptr==m_mirror )
+                m_mirror = memory::make_shared(new gsExprHelper(this));
+        }
         return *m_mirror;
     }
 
@@ -313,14 +367,14 @@ public:
         {
             //gsInfo<<"\nGot BC composition\n";
             mutMap = &sym.inner().source();
-            if (nullptr!=mutSrc)
+            if (nullptr!=mutSrc.mine())
             {
 #               pragma omp critical (m_fdata_first_touch)
                 const_cast<expr::gsComposition<T>&>(sym)
                     .setData( mutData );
 
                 const_cast<expr::gsComposition<T>&>(sym)
-                    .setSource(*mutSrc);
+                    .setSource(*mutSrc.mine());
             }
             else
                 gsWarn<<"\nSomething went terribly wrong here (add gsComposition).\n";
@@ -373,31 +427,51 @@ public:
         else
         {
             //gsDebug<<"\nGot a mutable variable.\n";
-            if (nullptr!=mutSrc)
+            if (nullptr!=mutSrc.mine())
             {
 #               pragma omp critical (m_fdata_first_touch)
                 const_cast<expr::symbol_expr<E>&>(sym)
                     .setData( mutData );
 
                 const_cast<expr::symbol_expr<E>&>(sym)
-                    .setSource(*mutSrc);
+                    .setSource(*mutSrc.mine());
             }
             else
                 gsWarn<<"\nSomething went wrong here (add symbol_expr).\n";
         }
     }
 
+    /// \brief Computes the data of all registered functions on the
+    /// current points.
+    ///
+    /// If the map cache is enabled (see setMapCache), \a elementId
+    /// is the index of the current element in the cache, or -1 for
+    /// no caching.
     void precompute(const index_t patchIndex = 0,
-                    boundary::side bs = boundary::none)
+                    boundary::side bs = boundary::none,
+                    const index_t elementId = -1)
     {
         //First compute the maps
         for (MapDataIt it = m_mdata.begin(); it != m_mdata.end(); ++it)
         {
-            it->second.mine().points.swap(m_points.mine());//swap
-            it->second.mine().side    = bs;
-            it->second.mine().patchId = patchIndex;
-            it->first->function(patchIndex).computeMap(it->second);
-            it->second.mine().points.swap(m_points.mine());
+            gsMapData<T> & md = it->second.mine();
+            gsMapData<T> * cd = ( -1==elementId || 0==m_mcacheSize ? nullptr :
+                                  &m_mcache.find(it->first)->second[elementId] );
+            if ( cd && (cd->flags & md.flags) == md.flags &&
+                 cd->points.cols()==m_points.mine().cols() ) // cache hit
+            {
+                const unsigned flg = md.flags;
+                md = *cd;
+                md.flags = flg;
+                continue;
+            }
+
+            md.points.swap(m_points.mine());//swap
+            md.side    = bs;
+            md.patchId = patchIndex;
+            it->first->function(patchIndex).computeMap(md);
+            if (cd) *cd = md;
+            md.points.swap(m_points.mine());
         }
 
         for (FuncDataIt it = m_fdata.begin(); it != m_fdata.end(); ++it)
@@ -415,14 +489,40 @@ public:
         }
 
         // Mutable variable to treat BCs
-        if (nullptr!=mutSrc && 0!=mutData.mine().flags)
+        if (nullptr!=mutSrc.mine() && 0!=mutData.mine().flags)
         {
-            mutSrc->piece(patchIndex)
+            mutSrc.mine()->piece(patchIndex)
                 .compute( mutMap ? m_mdata[mutMap].mine().values[0]
                           : m_points, mutData );
         }
     }
 
+    /// Returns the number of values computed by precompute() on the
+    /// calling thread (eg. for profiling)
+    index_t numValues() const
+    {
+        index_t n = 0;
+        for (typename MapData::const_iterator it = m_mdata.begin(); it != m_mdata.end(); ++it)
+            n += _numValues(it->second.mine());
+        for (typename FuncData::const_iterator it = m_fdata.begin(); it != m_fdata.end(); ++it)
+            n += _numValues(it->second.mine());
+        for (typename CFuncData::const_iterator it = m_cdata.begin(); it != m_cdata.end(); ++it)
+            n += _numValues(it->second.mine());
+        return n;
+    }
+
+private:
+
+    static index_t _numValues(const gsFuncData<T> & fd)
+    {
+        index_t n = 0;
+        for (size_t i = 0; i != fd.values.size(); ++i)
+            n += fd.values[i].size();
+        return n;
+    }
+
+public:
+
     void precompute(const boundaryInterface & iFace)
     {
         this->precompute( iFace.first ().patch, iFace.first().side() );
@@ -227,6 +227,34 @@ public:
     MatExprType eval(const index_t k) const
     { return static_cast<E const&>(*this).eval(k); }
 
+    /// \brief Evaluates the expression at the evaluation points
+    /// 0,..,\a n-1 (one call of eval() per point) and stores the
+    /// values side by side in \a res, ie. the value at point \a k is
+    /// the k-th block of columns of \a res
+    void evalBatch(const index_t n, gsMatrix<Scalar> & res) const
+    {
+        res.resize(0,0);
+        for (index_t k = 0; k != n; ++k)
+            _batchPut(static_cast<E const&>(*this).eval(k), k, n, res);
+    }
+
+private:
+    template<class M> static inline
+    void _batchPut(const M & ek, const index_t k, const index_t n, gsMatrix<Scalar> & res)
+    {
+        if (0==k) res.resize(ek.rows(), n*ek.cols());
+        res.middleCols(k*ek.cols(), ek.cols()) = ek;
+    }
+
+    static inline
+    void _batchPut(const Scalar & ek, const index_t k, const index_t n, gsMatrix<Scalar> & res)
+    {
+        if (0==k) res.resize(1, n);
+        res(0,k) = ek;
+    }
+
+public:
+
     /// Returns the transpose of the expression
     tr_expr<E> tr() const
     { return tr_expr<E,false>(static_cast<E const&>(*this)); }
@@ -1578,6 +1606,9 @@ public:
     tr_expr(_expr<E> const& u)
     : _u(u) { }
 
+    /// The transposed expression
+    const E & inner() const { return _u; }
+
 public:
     enum {ColBlocks = E::ColBlocks, ScalarValued=E::ScalarValued};
     enum {Space = cw?E::Space:(E::Space==1?2:(E::Space==2?1:E::Space))};
@@ -1757,7 +1788,7 @@ public:
     // choose if ColBlocks
     const gsMatrix<Scalar> & eval(const index_t k) const
     {
-        auto tmp = _u.eval(k);
+        const auto & tmp = _u.eval(k);
         const index_t cb = _u.rows();
         const index_t r  = _u.cardinality();
         if (Space==1)
@@ -1811,7 +1842,7 @@ public:
     // choose if ColBlocks
     const gsMatrix<Scalar> & eval(const index_t k) const
     {
-        auto tmp = _u.eval(k);
+        const auto & tmp = _u.eval(k);
         const index_t cb = _u.rows();
         const index_t r  = _u.cols() / cb;
         res.resize(_u.rows(),_u.cols());
@@ -2012,7 +2043,7 @@ flat_expr<E> const flat(E const & u)
         const gsMatrix<Scalar> & eval(const index_t k) const
         {
             // Assume mat ??
-            MatExprType tmp = _u.eval(k);
+            const MatExprType & tmp = _u.eval(k);
             const index_t cb = _u.rows();
             const index_t r  = _u.cols() / cb;
             res.resize(r, cb);
@@ -2099,7 +2130,7 @@ public:
 
     const gsMatrix<Scalar> & eval(const index_t k) const
     {
-        auto m = _u.eval(k);
+        const auto & m = _u.eval(k);
         const index_t r = m.rows();
         const index_t c = m.cols();
         res.resize(r,r*c);
@@ -2450,8 +2481,8 @@ public:
         const index_t r   = _u.rows();
         const index_t N  = _v.cols() / (r*r);
 
-        const auto uEv  = _u.eval(k);
-        const auto vEv  = _v.eval(k);
+        const auto & uEv = _u.eval(k);
+        const auto & vEv = _v.eval(k);
 
         res.resize(r, N*r*r);
         // gsDebugVar(res.cols());
@@ -2506,8 +2537,8 @@ public:
         const index_t r  = _u.rows();
         const index_t N  = _v.cols() / (r*r);
 
-        const auto uEv  = _u.eval(k);
-        const auto vEv  = _v.eval(k);
+        const auto & uEv = _u.eval(k);
+        const auto & vEv = _v.eval(k);
 
         res.resize(r, N*r*r);
         for (index_t s = 0; s!=r; ++s)
@@ -3570,6 +3601,125 @@ public:
     void print(std::ostream &os) const { os << "curl("; _u.print(os); os <<")"; }
 };
 
+/*
+  Small dense products with the dimension as a template parameter
+
+  The geometric factors of the expressions (the Jacobian matrix of
+  the map and its inverse, the blocks of vector-valued spaces) are
+  square matrices of size 2 or 3. As in gsFunction::computeMap, the
+  products involving them are dispatched on the actual size to
+  kernels in which the size is fixed at compile time, such that the
+  small factors are kept in stack-allocated fixed-size matrices and
+  the products are unrolled. The functions return false (and do
+  nothing) for other sizes.
+*/
+template<class T>
+struct fixed_dim
+{
+    /// res = A * B, for a square matrix B
+    template<class MA, class MB, class MR>
+    static bool mult(const MA & A, const MB & B, MR & res)
+    {
+        if ( B.rows()!=B.cols() ) return false;
+        switch (B.rows())
+        {
+        case 2: _mult<2>(A,B,res); return true;
+        case 3: _mult<3>(A,B,res); return true;
+        default: return false;
+        }
+    }
+
+    /// res = [A_1*B  A_2*B ... A_nb*B] for square blocks A_i of the
+    /// size of B. \a res must have the right size.
+    template<class MA, class MB, class MR>
+    static bool blockMult(const MA & A, const MB & B, MR & res, const index_t nb)
+    {
+        if ( A.rows()!=B.rows() || B.rows()!=B.cols() || A.cols()!=nb*B.rows() )
+            return false;
+        switch (B.rows())
+        {
+        case 2: _blockMult<2>(A,B,res,nb); return true;
+        case 3: _blockMult<3>(A,B,res,nb); return true;
+        default: return false;
+        }
+    }
+
+    /// res = [A_i*B_j]_{ij} for square blocks A_i and B_j of size \a
+    /// d. \a res must have the right size.
+    template<class MA, class MB, class MR>
+    static bool blockPairs(const MA & A, const MB & B, MR & res, const index_t d)
+    {
+        if ( A.rows()!=d || B.rows()!=d || res.rows()!=A.cols()
+             || res.cols()!=B.cols() ) return false;
+        switch (d)
+        {
+        case 2: _blockPairs<2>(A,B,res); return true;
+        case 3: _blockPairs<3>(A,B,res); return true;
+        default: return false;
+        }
+    }
+
+    /// res(i,j) = A_i : B_j (double dot product) for square blocks A_i
+    /// and B_j of size \a d. \a res must have the right size.
+    template<class MA, class MB, class MR>
+    static bool frobenius(const MA & A, const MB & B, MR & res, const index_t d)
+    {
+        if ( A.rows()!=d || B.rows()!=d || res.rows()*d!=A.cols()
+             || res.cols()*d!=B.cols() ) return false;
+        switch (d)
+        {
+        case 2: _frobenius<2>(A,B,res); return true;
+        case 3: _frobenius<3>(A,B,res); return true;
+        default: return false;
+        }
+    }
+
+private:
+
+    template<int D, class MA, class MB, class MR>
+    static void _mult(const MA & A, const MB & B, MR & res)
+    {
+        const Eigen::Matrix<T,D,D> b = B;
+        res.noalias() = A.lazyProduct(b);
+    }
+
+    template<int D, class MA, class MB, class MR>
+    static void _blockMult(const MA & A, const MB & B, MR & res, const index_t nb)
+    {
+        const Eigen::Matrix<T,D,D> b = B;
+        for (index_t i = 0; i!=nb; ++i)
+            res.template block<D,D>(0,i*D).noalias() =
+                A.template block<D,D>(0,i*D).lazyProduct(b);
+    }
+
+    template<int D, class MA, class MB, class MR>
+    static void _blockPairs(const MA & A, const MB & B, MR & res)
+    {
+        const index_t nb = A.cols() / D, nbv = B.cols() / D;
+        Eigen::Matrix<T,D,D> a;
+        for (index_t i = 0; i!=nb; ++i)
+        {
+            a = A.template block<D,D>(0,i*D);
+            for (index_t j = 0; j!=nbv; ++j)
+                res.template block<D,D>(i*D,j*D).noalias() =
+                    a.lazyProduct(B.template block<D,D>(0,j*D));
+        }
+    }
+
+    template<int D, class MA, class MB, class MR>
+    static void _frobenius(const MA & A, const MB & B, MR & res)
+    {
+        const index_t nb = A.cols() / D, nbv = B.cols() / D;
+        Eigen::Matrix<T,D,D> a;
+        for (index_t i = 0; i!=nb; ++i)
+        {
+            a = A.template block<D,D>(0,i*D);
+            for (index_t j = 0; j!=nbv; ++j)
+                res(i,j) = a.cwiseProduct(B.template block<D,D>(0,j*D)).sum();
+        }
+    }
+};
+
 /*
   Expression for multiplication operation (first version)
 
@@ -3597,6 +3747,11 @@ public:
               _expr<E2> const& v)
     : _u(u), _v(v) { }
 
+    /// The left factor
+    const E1 & first()  const { return _u; }
+    /// The right factor
+    const E2 & second() const { return _v; }
+
     mutable Temporary_t tmp;
     const Temporary_t & eval(const index_t k) const
     {
@@ -3605,7 +3760,7 @@ public:
                      << _u <<" times \n" << _v );
 
         // Note: a * b * c --> (a*b).eval()*c
-        tmp = _u.eval(k) * _v.eval(k);
+        _eval(_u.eval(k), _v.eval(k));
         return tmp; // assumes result is not scalarvalued
     }
 
@@ -3624,6 +3779,20 @@ public:
     { return 0==E2::Space ? _u.colVar() : _v.colVar(); }
 
     void print(std::ostream &os) const { _u.print(os); os<<"*"; _v.print(os); }
+
+private:
+
+    // Matrix times geometric (eg. Jacobian) matrix: fixed-size product
+    template<class MA, class MB, bool S = E1::ScalarValued || E2::ScalarValued || 0!=E2::Space>
+    typename util::enable_if<!S,void>::type _eval(const MA & a, const MB & b) const
+    {
+        if ( !fixed_dim<Scalar>::mult(a, b, tmp) )
+            tmp.noalias() = a * b;
+    }
+
+    template<class MA, class MB, bool S = E1::ScalarValued || E2::ScalarValued || 0!=E2::Space>
+    typename util::enable_if<S,void>::type _eval(const MA & a, const MB & b) const
+    { tmp = a * b; }
 };
 
 /*
@@ -3666,8 +3835,8 @@ public:
         const index_t uc = _u.cols();
         const index_t ur = _u.rows();
         const index_t nb = _u.cardinality();
-        const auto tmpA = _u.eval(k);
-        const auto tmpB = _v.eval(k);
+        const auto & tmpA = _u.eval(k);
+        const auto & tmpB = _v.eval(k);
 
         const index_t vc = _v.cols();
 
@@ -3678,6 +3847,8 @@ public:
             GISMO_ASSERT(tmpA.cols()==uc*nb, "Dimension error.. "<< tmpA.cols()<<"!="<<uc*nb );
             GISMO_ASSERT(1==_v.cardinality(), "Dimension error");
             //gsInfo<<"cols = "<<res.cols()<<"; rows = "<<res.rows()<<"\n";
+            if ( uc==vc && fixed_dim<Scalar>::blockMult(tmpA, tmpB, res, nb) )
+                return res;
             for (index_t i = 0; i!=nb; ++i)
                 res.middleCols(i*vc,vc).noalias()
                     = tmpA.middleCols(i*uc,uc) * tmpB;
@@ -3689,6 +3860,8 @@ public:
         {
             const index_t nbv = _v.cardinality();
             res.resize(ur*nb, vc*nbv);
+            if ( ur==uc && uc==vc && fixed_dim<Scalar>::blockPairs(tmpA, tmpB, res, ur) )
+                return res;
             for (index_t i = 0; i!=nb; ++i)
                 for (index_t j = 0; j!=nbv; ++j)
                 {
@@ -3798,8 +3971,8 @@ public:
     eval(const index_t k) const
     {
         const index_t nb = rows();
-        const auto tmpA = _u.eval(k);
-        const auto tmpB = _v.eval(k);
+        const auto & tmpA = _u.eval(k);
+        const auto & tmpB = _v.eval(k);
 
         if (E1::ColBlocks)
         {
@@ -3892,9 +4065,11 @@ public:
         // assert _u.size()==_v.size()
         const index_t rb = _u.rows();
         const index_t nb = _u.cardinality();
-        auto A = _u.eval(k);
-        auto B = _v.eval(k);
+        const auto & A = _u.eval(k);
+        const auto & B = _v.eval(k);
         res.resize(nb, nb);
+        if ( fixed_dim<Scalar>::frobenius(A, B, res, rb) )
+            return res;
         for (index_t i = 0; i!=nb; ++i) // all with all
             for (index_t j = 0; j!=nb; ++j)
                 res(i,j) =
@@ -3950,11 +4125,13 @@ public:
     const gsMatrix<Scalar> & eval(const index_t k) const //todo: specialize for nb==1
     {
         // assert _u.size()==_v.size()
-        auto A = _u.eval(k);
-        auto B = _v.eval(k);
+        const auto & A = _u.eval(k);
+        const auto & B = _v.eval(k);
         const index_t rb = A.rows(); //==cb
         const index_t nb = _u.cardinality();
         res.resize(nb, 1);
+        if ( B.cols()==rb && fixed_dim<Scalar>::frobenius(A, B, res, rb) )
+            return res;
         for (index_t i = 0; i!=nb; ++i) // all with all
             res(i,0) =
                 (A.middleCols(i*rb,rb).array() * B.array()).sum();
@@ -4117,6 +4294,11 @@ public:
             );
     }
 
+    /// The first term
+    const E1 & first()  const { return _u; }
+    /// The second term
+    const E2 & second() const { return _v; }
+
     mutable Temporary_t res;
     const Temporary_t & eval(const index_t k) const
     {
@@ -4171,9 +4353,9 @@ public:
 
     const gsMatrix<Scalar> & eval(const index_t k) const
     {
-        auto sl   = _u.eval(k);
+        const auto & sl = _u.eval(k);
         const index_t sr = sl.rows();
-        auto ml   = _M.eval(k);
+        const auto & ml = _M.eval(k);
         const index_t mr = ml.rows();
         const index_t mb = _M.cardinality();
 
@@ -4538,6 +4720,109 @@ operator-(typename E2::Scalar const& s, _expr<E2> const& v)
 }
 
 
+/*
+  Quadrature of an expression over the points of an element: the sum
+  over the points of products A(k) * B(k)^T becomes one matrix
+  product of the side by side values of A and B, instead of one small
+  product and one accumulation per point. The factors A and B are
+  still evaluated point by point (see evalBatch).
+
+  compute() returns false if the expression has no batched form, then
+  the caller has to sum the values at the points. gsExprAssembler uses
+  it if the option "BatchQuadrature" is set.
+*/
+template<class T>
+struct batch_outer
+{
+    // lm = sum_k c_k A(k) * B(k)^T
+    template<class E1, class E2>
+    static bool compute(const E1 & a, const E2 & b, const gsVector<T> & c,
+                        gsMatrix<T> & lm, gsMatrix<T> & A, gsMatrix<T> & B)
+    {
+        if (E1::ColBlocks || E2::ColBlocks || E1::ScalarValued || E2::ScalarValued)
+            return false;
+        const index_t n = c.size();
+        a.evalBatch(n, A);
+        b.evalBatch(n, B);
+        GISMO_ASSERT(B.cols()==A.cols(), "Dimension error in batched product.");
+        const index_t d = A.cols() / n;
+        for (index_t k = 0; k != n; ++k)
+            B.middleCols(k*d,d) *= c[k];
+        lm.noalias() = A * B.transpose();
+        return true;
+    }
+
+    template<class E1, class E2>
+    static typename util::enable_if<!util::is_same<E1,T>::value,bool>::type
+    compute(const mult_expr<E1,tr_expr<E2,false>,false> & e,
+            const gsVector<T> & c, gsMatrix<T> & lm,
+            gsMatrix<T> & A, gsMatrix<T> & B)
+    { return compute(e.first(), e.second().inner(), c, lm, A, B); }
+
+    template<class E>
+    static bool compute(const E &, const gsVector<T> &, gsMatrix<T> &,
+                        gsMatrix<T> &, gsMatrix<T> &)
+    { return false; }
+};
+
+template<class E, class Enable = void>
+struct batch_quadrature
+{
+    template<class T>
+    static bool compute(const E & e, const gsVector<T> & w, gsMatrix<T> & lm,
+                        gsMatrix<T> & A, gsMatrix<T> & B)
+    { return batch_outer<T>::compute(e, w, lm, A, B); }
+};
+
+// A + B, if both terms have a batched form
+template<class E1, class E2>
+struct batch_quadrature<add_expr<E1,E2> >
+{
+    template<class T>
+    static bool compute(const add_expr<E1,E2> & e,
+                        const gsVector<T> & w, gsMatrix<T> & lm,
+                        gsMatrix<T> & A, gsMatrix<T> & B)
+    {
+        gsMatrix<T> lm2;
+        if ( !batch_quadrature<E1>::compute(e.first(), w, lm, A, B) ||
+             !batch_quadrature<E2>::compute(e.second(), w, lm2, A, B) )
+            return false;
+        lm += lm2;
+        return true;
+    }
+};
+
+// (A * B^T) * s and u * s, with s scalar-valued
+template<class E1, class E2>
+struct batch_quadrature<mult_expr<E1,E2,false>,
+                        typename util::enable_if<!util::is_same<E1,typename E2::Scalar>::value>::type>
+{
+    template<class T>
+    static bool compute(const mult_expr<E1,E2,false> & e,
+                        const gsVector<T> & w, gsMatrix<T> & lm,
+                        gsMatrix<T> & A, gsMatrix<T> & B)
+    {
+        if ( batch_outer<T>::compute(e, w, lm, A, B) ) // A * B^T
+            return true;
+        if (!E2::ScalarValued || E1::ScalarValued || E1::ColBlocks)
+            return false;
+
+        e.second().evalBatch(w.size(), A);
+        const gsVector<T> c = A.row(0).transpose().cwiseProduct(w);
+        if ( batch_outer<T>::compute(e.first(), c, lm, A, B) )
+            return true;
+
+        // vector expression: lm = sum_k c_k u(k)
+        if (3==E1::Space)
+            return false;
+        e.first().evalBatch(w.size(), A);
+        if (A.cols()!=w.size())
+            return false;
+        lm.noalias() = A * c;
+        return true;
+    }
+};
+
 // Shortcuts for common quantities, for instance function
 // transformations by the geometry map \a G
 #define GISMO_SHORTCUT_VAR_EXPRESSION(name,impl) template<class E> EIGEN_STRONG_INLINE \
@@ -26,6 +26,19 @@ namespace gismo
     - Explicit Euler scheme (theta=0)
     - Crank-Nicolson semi-implicit scheme (theta=0.5)
     - implicit Euler scheme (theta=1)
+
+    The mass and the stiffness matrix are assembled once, with the
+    same sparsity pattern. The system matrix of a time step is a
+    linear combination of their values, and it is formed again only
+    if the time step size changes.
+
+    The stiffness matrix is a copy of the matrix of the stationary
+    assembler. It is copied again at the next time step whenever the
+    stationary assembler has been assembled again in between (see
+    gsAssembler::revision()), eg. with new coefficients; if the size
+    of the matrix changed, assembleMass() has to be called as well.
+    After changing the stationary matrix by other means, call
+    refreshStiffness().
     
     \ingroup Assembler
 */
@@ -40,7 +53,8 @@ public:
     /// Construction receiving all necessary data
     explicit gsHeatEquation(gsAssembler<T> & stationary)
     :  Base(stationary),  // note: unnecessary sliced copy here
-       m_stationary(&stationary), m_theta(0.5)
+       m_stationary(&stationary), m_stiffRev(0),
+       m_theta(0.5), m_dt(0)
     {
         m_options.addReal("theta",
         "Theta parameter determining the time integration scheme [0..1]", m_theta);
@@ -53,6 +67,7 @@ public:
         GISMO_ASSERT(th<=1 && th>=0, "Invalid value");
         m_theta= th;
         m_options.setReal("theta", m_theta);
+        m_dt = 0;
     }
     
     /// Initial assembly routine.
@@ -82,8 +97,13 @@ public:
        \param curSolution The solution of the previous timestep
 
        \param Dt Length of time interval of the current time step
+
+       \returns true if the system matrix changed, ie. if \a Dt
+       differs from the previous time step. Otherwise the
+       factorization (or preconditioner) of the previous step can
+       be reused.
     */
-    void nextTimeStep(const gsMatrix<T> & curSolution, const T Dt);
+    bool nextTimeStep(const gsMatrix<T> & curSolution, const T Dt);
     
     void nextTimeStep(const gsSparseMatrix<T> & sysMatrix,
                       const gsSparseMatrix<T> & massMatrix,
@@ -100,11 +120,21 @@ public:
 
     const gsSparseMatrix<T> & mass() const { return m_mass; }
     const gsSparseMatrix<T> & stationaryMatrix() const { return m_stationary->matrix(); }
-    const gsSparseMatrix<T> & stationaryRhs() const { return m_stationary->rhs(); }
+    const gsMatrix<T> & stationaryRhs() const { return m_stationary->rhs(); }
     
     /// Mass assembly routine
     void assembleMass();
 
+    /// \brief Discards the copy of the stiffness matrix, the next
+    /// time step reads the matrix of the stationary assembler again.
+    /// Re-assembly of the stationary problem is detected by itself,
+    /// this is needed only if its matrix was modified otherwise.
+    void refreshStiffness()
+    {
+        m_stiff.resize(0,0);
+        m_dt = 0;
+    }
+
 protected:
 
     using Base::m_options;
@@ -116,9 +146,21 @@ protected:
     
     /// The mass matrix
     gsSparseMatrix<T> m_mass;
+
+    /// The stiffness matrix, with the sparsity pattern of m_mass
+    /// (set up at the first time step, see refreshStiffness())
+    gsSparseMatrix<T> m_stiff;
+
+    /// Revision of the stationary assembler which m_stiff was
+    /// copied from
+    size_t m_stiffRev;
     
     /// Theta parameter determining the scheme
     T m_theta;
+
+    /// Time step size of the current system matrix (zero if the
+    /// system matrix is not a combination of m_mass and m_stiff)
+    T m_dt;
     
     using Base::m_pde_ptr;
     using Base::m_bases;
@@ -133,10 +175,52 @@ namespace gismo
 {
 
 template<class T>
-void gsHeatEquation<T>::nextTimeStep(const gsMatrix<T> & curSolution, const T Dt)
+bool gsHeatEquation<T>::nextTimeStep(const gsMatrix<T> & curSolution, const T Dt)
 {
-    nextTimeStepFixedRhs(m_stationary->matrix(), m_mass,
-                         m_stationary->rhs(), curSolution, Dt);
+    GISMO_ASSERT( curSolution.rows() == m_mass.cols(),
+                  "Wrong size in current solution vector.");
+
+    // Stationary matrix assembled again ?
+    const gsSparseMatrix<T> & stat = m_stationary->matrix();
+    if ( 0 != m_stiff.rows() && m_stationary->revision() != m_stiffRev )
+        refreshStiffness();
+
+    const bool newMatrix = (Dt != m_dt);
+    if ( newMatrix )
+    {
+        if ( 0 == m_stiff.rows() )
+        {
+            // Mass and stiffness matrix on the union of their
+            // patterns (the sums keep explicit zeros). The
+            // stationary matrix is assumed constant in time
+            // (see refreshStiffness())
+            GISMO_ASSERT( stat.rows() == m_mass.rows(),
+                          "Stationary matrix changed size, call assembleMass().");
+            m_mass  = m_mass + T(0) * stat;
+            m_stiff = stat + T(0) * m_mass;
+            m_stiffRev = m_stationary->revision();
+            GISMO_ASSERT( m_stiff.nonZeros() == m_mass.nonZeros(),
+                          "Different sparsity patterns.");
+        }
+
+        if ( 0 == m_dt ) // copy the common sparsity pattern
+            m_system.matrix() = m_mass;
+
+        // M + c1 * K, value by value
+        const index_t nz = m_mass.nonZeros();
+        const T c1 = Dt * m_theta;
+        gsAsVector<T>(m_system.matrix().valuePtr(), nz) =
+            gsAsConstVector<T>(m_mass.valuePtr(), nz) +
+            c1 * gsAsConstVector<T>(m_stiff.valuePtr(), nz);
+        m_dt = Dt;
+    }
+
+    const T c2 = Dt * (1.0 - m_theta);
+    m_system.rhs().noalias() = Dt * m_stationary->rhs() + m_mass * curSolution;
+    if ( 0 != c2 )
+        m_system.rhs().noalias() -= c2 * (m_stiff * curSolution);
+
+    return newMatrix;
 }
 
 /*
@@ -170,6 +254,7 @@ void gsHeatEquation<T>::nextTimeStep(const gsSparseMatrix<T> & sysMatrix,
 
     const T c1 = Dt * m_theta;
     m_system.matrix() = massMatrix + c1 * sysMatrix;
+    m_dt = 0;
 
     const T c2 = Dt * (1.0 - m_theta);
     m_system.rhs().noalias() = c1 * rhs1 + c2 * rhs0 + (massMatrix - c2 * sysMatrix) * curSolution;
@@ -187,6 +272,7 @@ void gsHeatEquation<T>::nextTimeStepFixedRhs(const gsSparseMatrix<T> & sysMatrix
 
     const T c1 = Dt * m_theta;
     m_system.matrix() = massMatrix + c1 * sysMatrix;
+    m_dt = 0;
 
     const T c2 = Dt * (1.0 - m_theta);
     m_system.rhs().noalias() = Dt * rhs + (massMatrix - c2 * sysMatrix) * curSolution;
@@ -210,19 +296,16 @@ void gsHeatEquation<T>::assembleMass()
     // sparse matrix
     m_system.reserve(m_bases[0], m_options, 1);// zero rhs's
 
-    // Assemble mass integrals
+    // Assemble mass integrals, on the elements of all patches
     gsVisitorMass<T> mass;
-    for (size_t np=0; np < m_pde_ptr->domain().nPatches(); ++np )
-    {
-        //Assemble mass matrix for this patch
-        this->apply(mass, np);
-    }
+    this->push(mass);
 
     // Assembly is done, compress the matrix
     this->finalize();
 
     // Store the mass matrix once and for all
     m_system.matrix().swap(m_mass);
+    refreshStiffness();
 }
 
 } // namespace gismo
@@ -19,6 +19,7 @@
 #include <gsAssembler/gsNewtonCotesRule.h>
 #include <gsAssembler/gsPatchRule.h>
 #include <gsAssembler/gsOverIntegrateRule.h>
+#include <gsAssembler/gsWeightedRule.h>
 
 namespace gismo
 {
@@ -33,7 +34,8 @@ struct gsQuadrature
     {
         GaussLegendre = 1, ///< Gauss-Legendre quadrature
         GaussLobatto  = 2, ///< Gauss-Lobatto quadrature
-        PatchRule     = 3  ///< Patch-wise quadrature rule  (Johannessen 2017)
+        PatchRule     = 3, ///< Patch-wise quadrature rule  (Johannessen 2017)
+        WeightedQuadrature = 4 ///< Weighted quadrature (Calabro et al. 2017), sum-factorized visitors only
 
     };
     /*
@@ -48,10 +50,19 @@ struct gsQuadrature
     static gsQuadRule<T> get(const gsBasis<T> & basis,
                              const gsOptionList & options, short_t fixDir = -1)
     {
-        const index_t qu  = options.askInt("quRule", GaussLegendre);
+        index_t       qu  = options.askInt("quRule", GaussLegendre);
         const Real    quA = options.getReal("quA");
         const index_t quB = options.getInt ("quB");
         const gsVector<index_t> nnodes = numNodes(basis,quA,quB,fixDir);
+        if (qu==WeightedQuadrature)
+        {
+            // Weighted quadrature is a volume rule, boundary and
+            // interface integrals use Gauss-Legendre
+            GISMO_ENSURE(-1!=fixDir, "Weighted quadrature has test-function "
+                         "dependent weights and is only available for "
+                         "sum-factorized assembly (see gsSumFactorization).");
+            qu = GaussLegendre;
+        }
         return get<T>(qu, nnodes);
     }
 
@@ -110,6 +121,15 @@ struct gsQuadrature
             // quB: Regularity of the target space
             return gsPatchRule<T>::make(basis,cast<T,index_t>(quA),quB,over,fixDir);
         }
+        else if (qu==WeightedQuadrature)
+        {
+            // Weighted quadrature is a volume rule, boundary and
+            // interface integrals use Gauss-Legendre
+            GISMO_ENSURE(-1!=fixDir, "Weighted quadrature has test-function "
+                         "dependent weights and is only available for "
+                         "sum-factorized assembly (see gsSumFactorization).");
+            return gsGaussRule<T>::make(numNodes(basis,quA,quB,fixDir));
+        }
         else
         {
             GISMO_ERROR("Quadrature with index "<<qu<<" unknown.");
@@ -376,6 +376,43 @@ public:
         m_rhs   .setZero();
     }
 
+    /**
+     * @brief Makes this an empty system with the block structure
+     * (mappers, blocks and right-hand side size) of \a other. This is
+     * used for thread-local systems in parallel assembly, which are
+     * added to \a other at the end (see add()).
+     * @param[in] other the system to copy the structure from
+     * @param[in] nz Non-zeros per column for the sparse matrix
+     */
+    void setupLike(const gsSparseSystem & other, const index_t nz)
+    {
+        m_mappers = other.m_mappers;
+        m_row     = other.m_row;
+        m_col     = other.m_col;
+        m_rstr    = other.m_rstr;
+        m_cstr    = other.m_cstr;
+        m_cvar    = other.m_cvar;
+        m_dims    = other.m_dims;
+        m_matrix.resize(other.m_matrix.rows(), other.m_matrix.cols());
+        if ( 0 != m_matrix.cols() )
+            m_matrix.reservePerColumn(nz);
+        m_rhs.setZero(other.m_rhs.rows(), other.m_rhs.cols());
+    }
+
+    /// @brief Adds the matrix and the right-hand side of \a other,
+    /// which has the same structure, to this system
+    void add(const gsSparseSystem & other)
+    {
+        GISMO_ASSERT( m_matrix.rows()==other.m_matrix.rows() &&
+                      m_matrix.cols()==other.m_matrix.cols() &&
+                      m_rhs.rows()==other.m_rhs.rows() &&
+                      m_rhs.cols()==other.m_rhs.cols(),
+                      "The systems have different dimensions.");
+        if ( 0 != other.m_matrix.nonZeros() )
+            m_matrix += other.m_matrix;
+        m_rhs += other.m_rhs;
+    }
+
     /// @brief the number of matrix columns
     index_t cols() const { return m_matrix.cols(); }
 
@@ -0,0 +1,339 @@
+/** @file gsSumFactorization.h
+
+    @brief Sum-factorized computation of element matrices on
+    tensor-product bases
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#pragma once
+
+#include <gsTensor/gsTensorBasis.h>
+#include <gsAssembler/gsQuadrature.h>
+#include <gsUtils/gsPointGrid.h>
+
+namespace gismo
+{
+
+/**
+   @brief Computes element matrices of bilinear forms on
+   tensor-product bases by sum factorization.
+
+   The element matrix of the bilinear form
+   \f[ M_{IJ} = \sum_{q} \sum_{a,b=0}^d c_{ab}(x_q)\, D_a N_I(x_q)\, D_b N_J(x_q), \f]
+   where \f$D_0\f$ is the identity and \f$D_a\f$, \f$a>0\f$ the
+   parametric derivative in direction \f$a\f$, is computed by
+   contracting the quadrature points one direction at a time. Only
+   the values of the univariate component bases are used. The
+   coefficients \f$c_{ab}\f$ (which contain the quadrature weights
+   and the geometry terms) may vary over the quadrature points. On
+   an element with \f$p+1\f$ active functions and quadrature nodes
+   per direction, the cost is \f$O(p^{2d+1})\f$ instead of the
+   \f$O(p^{3d})\f$ of the point-wise accumulation.
+
+   The quadrature nodes on the element must form a tensor grid with
+   the first coordinate running fastest, as produced by gsGaussRule
+   and gsLobattoRule. The rows and columns of the element matrix are
+   ordered as the active functions of the tensor basis.
+
+   If the option "quRule" is gsQuadrature::WeightedQuadrature, the
+   test-dependent weights of a gsWeightedRule are used in place of
+   the values of the test functions. In this case evaluate()
+   replaces the element nodes by the nodes of the weighted rule and
+   the coefficients must not contain the quadrature weights (see
+   weight()). The weighted rules are computed once per basis and
+   shared by all copies of the object, eg. by the thread-private
+   copies of a visitor. gsAssembler calls init() on every patch
+   before its parallel region, so the threads only look them up.
+
+   It is used by the visitors gsVisitorMass, gsVisitorGradGrad,
+   gsVisitorPoisson and gsVisitorCDR when the option
+   "SumFactorization" is set.
+
+   \ingroup Assembler
+*/
+template<class T>
+class gsSumFactorization
+{
+public:
+
+    gsSumFactorization() : m_rules(new ruleMap) { }
+
+    /// \brief Initializes the univariate components of \a basis.
+    ///
+    /// Returns true if sum factorization is enabled in \a options
+    /// and applicable, ie. \a basis is a tensor-product basis and
+    /// the quadrature rule defined by \a options is a tensor Gauss
+    /// or Lobatto rule or a weighted quadrature rule.
+    bool init(const gsBasis<T> & basis, const gsOptionList & options)
+    {
+        m_comp.clear();
+        m_wq.reset();
+        if ( !options.askSwitch("SumFactorization", false) )
+            return false;
+
+        const index_t qu = options.askInt("quRule", gsQuadrature::GaussLegendre);
+        if ( (qu!=gsQuadrature::GaussLegendre && qu!=gsQuadrature::GaussLobatto
+              && qu!=gsQuadrature::WeightedQuadrature)
+             || options.askSwitch("overInt", false) )
+            return false;
+
+        if ( !tensorComponents(basis, m_comp) || m_comp.size() < 2 )
+        {
+            m_comp.clear();
+            return false;
+        }
+
+        if ( qu==gsQuadrature::WeightedQuadrature )
+        {
+            m_wq = sharedRule(basis, options.askInt("quWQ",2));
+            m_numNodes.resize(m_comp.size());
+            m_elem.resize(m_comp.size());
+        }
+        else
+            m_numNodes = gsQuadrature::numNodes(basis, options.getReal("quA"),
+                                                options.getInt("quB"));
+        m_vals.resize(m_comp.size());
+        m_ders.resize(m_comp.size());
+        return true;
+    }
+
+    /// Returns true if the object was initialized successfully
+    bool enabled() const { return !m_comp.empty(); }
+
+    /// \brief Returns the element quadrature rule defined by \a
+    /// options. With weighted quadrature this is a Gauss rule, whose
+    /// nodes are only used to locate the element (see evaluate())
+    gsQuadRule<T> rule(const gsBasis<T> & basis, const gsOptionList & options) const
+    {
+        if ( !weighted() )
+            return gsQuadrature::get(basis, options);
+        return gsQuadrature::get<T>(gsQuadrature::GaussLegendre,
+                                    gsQuadrature::numNodes(basis, options.getReal("quA"),
+                                                           options.getInt("quB")));
+    }
+
+    /// Parametric dimension
+    short_t dim() const { return m_comp.size(); }
+
+    /// Returns true if weighted quadrature is used
+    bool weighted() const { return nullptr!=m_wq; }
+
+    /// \brief Returns the quadrature weight to be multiplied into the
+    /// coefficients at node \a k, ie. \a quWeights[k], or one if
+    /// weighted quadrature is used
+    T weight(const gsVector<T> & quWeights, const index_t k) const
+    { return weighted() ? (T)(1) : quWeights[k]; }
+
+    /// \brief Evaluates the univariate bases on the element with
+    /// (tensor-grid) quadrature nodes \a nodes.
+    ///
+    /// The first derivatives are computed as well if \a ders is
+    /// true. With weighted quadrature, \a nodes is replaced by the
+    /// nodes of the weighted rule on the same element.
+    void evaluate(gsMatrix<T> & nodes, const bool ders)
+    {
+        const short_t d = dim();
+        if ( weighted() )
+        {
+            std::vector<gsVector<T> > grid(d);
+            for (short_t k = 0; k != d; ++k)
+            {
+                m_elem[k] = m_wq->elementIndex(k, nodes(k,0));
+                grid[k] = m_wq->nodes(k, m_elem[k]);
+                m_numNodes[k] = grid[k].size();
+            }
+            gsPointGrid(grid, nodes);
+        }
+        GISMO_ASSERT(nodes.rows()==d && nodes.cols()==m_numNodes.prod(),
+                     "The quadrature nodes do not form a tensor grid.");
+        index_t stride = 1;
+        for (short_t k = 0; k != d; ++k)
+        {
+            m_nodes.resize(1, m_numNodes[k]);
+            for (index_t i = 0; i != m_numNodes[k]; ++i)
+                m_nodes(0,i) = nodes(k, i*stride);
+            stride *= m_numNodes[k];
+
+            m_comp[k]->eval_into(m_nodes, m_vals[k]);
+            if (ders)
+                m_comp[k]->deriv_into(m_nodes, m_ders[k]);
+        }
+    }
+
+    /// \brief Adds the element matrix of the bilinear form with
+    /// coefficients \a coefs to \a result.
+    ///
+    /// The coefficient \f$c_{ab}\f$ at the quadrature node \a q is
+    /// coefs(a+(d+1)*b, q). Coefficients which are zero at all nodes
+    /// are skipped.
+    void assemble(const gsMatrix<T> & coefs, gsMatrix<T> & result)
+    {
+        const short_t d = dim();
+        GISMO_ASSERT(coefs.rows()==(d+1)*(d+1) && coefs.cols()==m_numNodes.prod(),
+                     "Invalid size of the coefficients.");
+
+        std::vector<const gsMatrix<T>*> U(d), V(d);
+        for (short_t b = 0; b <= d; ++b)
+            for (short_t a = 0; a <= d; ++a)
+            {
+                const index_t r = a + (d+1)*b;
+                if ( (coefs.row(r).array() == 0).all() )
+                    continue;
+
+                for (short_t k = 0; k != d; ++k)
+                {
+                    U[k] = weighted() ? &m_wq->testWeights(k, m_elem[k], k+1==a, k+1==b)
+                        : (k+1==a ? &m_ders[k] : &m_vals[k]);
+                    V[k] = (k+1==b ? &m_ders[k] : &m_vals[k]);
+                }
+                m_coef = coefs.row(r).transpose();
+                contract(U, V, result);
+            }
+    }
+
+    /// \brief Adds the element load vector(s) with coefficients \a
+    /// coefs to \a result.
+    ///
+    /// Column \a r of \a result is incremented by \f$\sum_q
+    /// c_r(x_q) N_I(x_q)\f$, where \f$c_r(x_q)\f$ is coefs(r,q).
+    void assembleRhs(const gsMatrix<T> & coefs, gsMatrix<T> & result)
+    {
+        const short_t d = dim();
+        GISMO_ASSERT(coefs.cols()==m_numNodes.prod() && coefs.rows()==result.cols(),
+                     "Invalid size of the coefficients.");
+
+        std::vector<const gsMatrix<T>*> U(d), V(d);
+        m_ones.resize(d);
+        for (short_t k = 0; k != d; ++k)
+        {
+            m_ones[k].setOnes(1, m_numNodes[k]);
+            U[k] = weighted() ? &m_wq->testWeights(k, m_elem[k], false, false)
+                : &m_vals[k];
+            V[k] = &m_ones[k];
+        }
+        for (index_t r = 0; r != coefs.rows(); ++r)
+        {
+            m_coef = coefs.row(r).transpose();
+            m_col.setZero(result.rows(), 1);
+            contract(U, V, m_col);
+            result.col(r) += m_col;
+        }
+    }
+
+private:
+
+    // Returns the weighted quadrature rule with numNodes interior
+    // nodes for basis, which is computed only if it is not available
+    // to this object or its copies yet. Requires m_comp.
+    typename gsWeightedRule<T>::Ptr sharedRule(const gsBasis<T> & basis,
+                                               const index_t numNodes)
+    {
+        typename gsWeightedRule<T>::Ptr result;
+#       pragma omp critical(gsSumFactorization_rules)
+        {
+            typename gsWeightedRule<T>::Ptr & wq = (*m_rules)[std::make_pair(&basis,numNodes)];
+            // Recompute if the basis has been refined in place
+            bool valid = nullptr!=wq;
+            for (size_t k = 0; valid && k != m_comp.size(); ++k)
+                valid = wq->numElements(k) == m_comp[k]->numElements();
+            if ( !valid )
+                wq = memory::make_shared( new gsWeightedRule<T>(basis, numNodes) );
+            result = wq;
+        }
+        return result;
+    }
+
+    // Adds sum_q m_coef(q) prod_k U_k(i_k,q_k) V_k(j_k,q_k) to result(I,J)
+    void contract(const std::vector<const gsMatrix<T>*> & U,
+                  const std::vector<const gsMatrix<T>*> & V,
+                  gsMatrix<T> & result)
+    {
+        const short_t d = dim();
+        index_t L = 1, R = m_coef.size();
+        gsVector<T> * in = &m_coef, * out = &m_tmp;
+
+        // Contract direction k: the tensor (L, q_k, R) becomes
+        // (L, n_k*m_k, R) where L collects the (i_l,j_l) of the
+        // directions l<k and R the quadrature nodes of l>k
+        for (short_t k = 0; k != d; ++k)
+        {
+            const index_t n = U[k]->rows(), m = V[k]->rows(), q = m_numNodes[k];
+            R /= q;
+
+            // univariate products: m_prod(i+n*j, s) = U_k(i,s) * V_k(j,s)
+            m_prod.resize(n*m, q);
+            for (index_t j = 0; j != m; ++j)
+                m_prod.middleRows(j*n, n).array() =
+                    U[k]->array().rowwise() * V[k]->row(j).array();
+
+            out->resize(L*n*m*R);
+            for (index_t r = 0; r != R; ++r)
+            {
+                gsAsMatrix<T>(out->data() + r*L*n*m, L, n*m).noalias() =
+                    gsAsConstMatrix<T>(in->data() + r*L*q, L, q) * m_prod.transpose();
+            }
+            std::swap(in, out);
+            L *= n*m;
+        }
+
+        // Scatter to the element matrix
+        gsVector<index_t> cur(2*d), sz(2*d), rstr(d), cstr(d);
+        index_t ns = 1, ms = 1;
+        for (short_t k = 0; k != d; ++k)
+        {
+            sz[2*k]   = U[k]->rows();
+            sz[2*k+1] = V[k]->rows();
+            rstr[k] = ns; ns *= sz[2*k];
+            cstr[k] = ms; ms *= sz[2*k+1];
+        }
+        GISMO_ASSERT(result.rows()==ns && result.cols()==ms,
+                     "The element matrix has wrong size.");
+        cur.setZero();
+        const T * val = in->data();
+        do
+        {
+            index_t I = 0, J = 0;
+            for (short_t k = 0; k != d; ++k)
+            {
+                I += cur[2*k  ] * rstr[k];
+                J += cur[2*k+1] * cstr[k];
+            }
+            result(I,J) += *(val++);
+        } while (nextLexicographic(cur, sz));
+    }
+
+private:
+
+    // Univariate components of the tensor basis
+    std::vector<const gsBasis<T>*> m_comp;
+
+    // Weighted quadrature rules per basis and number of nodes,
+    // shared by copies
+    typedef std::map<std::pair<const gsBasis<T>*,index_t>,
+                     typename gsWeightedRule<T>::Ptr> ruleMap;
+    memory::shared_ptr<ruleMap> m_rules;
+
+    // Weighted quadrature rule on the current patch and current element
+    typename gsWeightedRule<T>::Ptr m_wq;
+    gsVector<index_t> m_elem;
+
+    // Number of quadrature nodes per direction
+    gsVector<index_t> m_numNodes;
+
+    // Univariate values and derivatives on the current element
+    std::vector<gsMatrix<T> > m_vals, m_ders;
+
+    // Temporaries
+    gsMatrix<T> m_nodes, m_prod, m_col;
+    std::vector<gsMatrix<T> > m_ones;
+    gsVector<T> m_coef, m_tmp;
+};
+
+} // namespace gismo
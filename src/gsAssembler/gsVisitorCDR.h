@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <gsAssembler/gsSumFactorization.h>
+
 namespace gismo
 {
 
@@ -53,6 +55,7 @@ public:
         rhs_ptr     = cdr->rhs       ();
 
         flagStabType = stabilizerCDR::none;
+        useSumFact   = false;
 
         GISMO_ASSERT( rhs_ptr->targetDim() == 1 ,
                       "Not yet tested for multiple right-hand-sides");
@@ -82,7 +85,7 @@ public:
                  stabilizerCDR::method flagStabilization = stabilizerCDR::SUPG) :
         rhs_ptr(&rhs),
         coeff_A_ptr( & coeff_A),coeff_b_ptr( & coeff_b),coeff_c_ptr( & coeff_c),
-        flagStabType( flagStabilization )
+        flagStabType( flagStabilization ), useSumFact(false)
     {
         GISMO_ASSERT( rhs.targetDim() == 1 ,"Not yet tested for multiple right-hand-sides");
         GISMO_ASSERT( flagStabilization == stabilizerCDR::none || flagStabilization == stabilizerCDR::SUPG, "flagStabilization not known");
@@ -94,12 +97,17 @@ public:
                     const gsOptionList & options,
                     gsQuadRule<T>    & rule)
     {
-        // Setup Quadrature
-        rule = gsQuadrature::get(basis, options); // harmless slicing occurs here
-
         //flagStabType = static_cast<unsigned>(options.askSwitch("SUPG", false));
         flagStabType = static_cast<stabilizerCDR::method>(options.askInt("Stabilization", stabilizerCDR::none));
 
+        // Use sum factorization on tensor-product bases, if
+        // requested (not with SUPG stabilization)
+        useSumFact = sumFact.init(basis, options) && flagStabType == stabilizerCDR::none;
+
+        // Setup Quadrature
+        rule = useSumFact ? sumFact.rule(basis, options)
+                          : gsQuadrature::get(basis, options); // harmless slicing occurs here
+
         // Set Geometry evaluation flags
         md.flags = NEED_VALUE | NEED_MEASURE | NEED_GRAD_TRANSFORM | NEED_2ND_DER;
     }
@@ -118,7 +126,12 @@ public:
         numActive = actives.rows();
 
         // Evaluate basis functions on element
-        basis.evalAllDers_into(md.points, 2, basisData);
+        if ( useSumFact )
+        {
+            sumFact.evaluate(md.points, true);
+        }
+        else
+            basis.evalAllDers_into(md.points, 2, basisData);
 
         // Compute image of Gauss nodes under geometry mapping as well as Jacobians
         geo.computeMap(md);
@@ -143,6 +156,40 @@ public:
 
         const index_t N = numActive;
 
+        if ( useSumFact )
+        {
+            const short_t d = sumFact.dim();
+            coefs.setZero((d+1)*(d+1), md.points.cols());
+            rhsCoefs.resize(rhsVals.rows(), md.points.cols());
+            for (index_t k = 0; k < md.points.cols(); ++k) // loop over quadrature nodes
+            {
+                // Multiply weight by the geometry measure
+                const T weight = sumFact.weight(quWeights,k) * md.measure(k);
+
+                const gsMatrix<T> jacInvTr = md.jacobian(k).cramerInverse().transpose();
+                gsMatrix<T> tmp_A = coeff_A_vals.col(k);
+                tmp_A.resize(d,d);
+
+                // Parametric form of the diffusion term
+                const gsMatrix<T> tmp_K = jacInvTr.transpose() * tmp_A * jacInvTr;
+                // Parametric form of the convection velocity
+                const gsMatrix<T> tmp_b = jacInvTr.transpose() * coeff_b_vals.col(k);
+
+                for (short_t b = 0; b != d; ++b)
+                {
+                    for (short_t a = 0; a != d; ++a)
+                        coefs(a+1 + (d+1)*(b+1), k) = weight * tmp_K(a,b);
+                    coefs((d+1)*(b+1), k) = weight * tmp_b(b,0);
+                }
+                coefs(0, k) = weight * coeff_c_vals(0,k);
+
+                rhsCoefs.col(k) = weight * rhsVals.col(k);
+            }
+            sumFact.assemble(coefs, localMat);
+            sumFact.assembleRhs(rhsCoefs, localRhs);
+            return;
+        }
+
         gsMatrix<T> & basisVals  = basisData[0];
         gsMatrix<T> & basisGrads = basisData[1];
         gsMatrix<T> & basis2ndDerivs = basisData[2];
@@ -407,6 +454,11 @@ protected:
 
     const gsGeometry<T> * base;
     gsMapData<T> md;
+
+    // Sum factorization data and coefficients
+    gsSumFactorization<T> sumFact;
+    gsMatrix<T> coefs, rhsCoefs;
+    bool useSumFact;
 };
 
 
@@ -49,8 +49,12 @@ public:
                     const gsOptionList & options,
                     gsQuadRule<T>    & rule)
     {
+        // Use sum factorization on tensor-product bases, if requested
+        sumFact.init(basis, options);
+
         // Setup Quadrature
-        rule = gsQuadrature::get(basis, options); // harmless slicing occurs here
+        rule = sumFact.enabled() ? sumFact.rule(basis, options)
+                                 : gsQuadrature::get(basis, options); // harmless slicing occurs here
 
         // Set Geometry evaluation flags
         md.flags = NEED_MEASURE|NEED_GRAD_TRANSFORM;
@@ -69,7 +73,10 @@ public:
         const index_t numActive = actives.rows();
 
         // Evaluate basis functions on element
-        basis.deriv_into(md.points, basisData);
+        if ( sumFact.enabled() )
+            sumFact.evaluate(md.points, true);
+        else
+            basis.deriv_into(md.points, basisData);
 
         // Compute geometry related values
         geo.computeMap(md);
@@ -82,6 +89,24 @@ public:
     inline void assemble(gsDomainIterator<T>    & /*element*/,
                          gsVector<T> const      & quWeights)
     {
+        if ( sumFact.enabled() )
+        {
+            const short_t d = sumFact.dim();
+            coefs.setZero((d+1)*(d+1), md.points.cols());
+            for (index_t k = 0; k < md.points.cols(); ++k) // loop over quadrature nodes
+            {
+                // Parametric form of grad(u).grad(v), scaled by weight and measure
+                const T weight = sumFact.weight(quWeights,k) * md.measure(k);
+                jacInvTr = md.jacobian(k).cramerInverse().transpose();
+                tmpK.noalias() = jacInvTr.transpose() * jacInvTr;
+                for (short_t b = 0; b != d; ++b)
+                    for (short_t a = 0; a != d; ++a)
+                        coefs(a+1 + (d+1)*(b+1), k) = weight * tmpK(a,b);
+            }
+            sumFact.assemble(coefs, localMat);
+            return;
+        }
+
         for (index_t k = 0; k < quWeights.rows(); ++k) // loop over quadrature nodes
         {
             // Multiply quadrature weight by the geometry measure
@@ -101,6 +126,7 @@ private:
 
     // Gradient values
     gsMatrix<T>  basisPhGrads;
+    gsMatrix<T>  jacInvTr, tmpK;
     using Base:: basisData;
     using Base::actives;
 
@@ -108,6 +134,9 @@ private:
     using Base::localMat;
 
     using Base::md;
+
+    using Base::sumFact;
+    using Base::coefs;
 };
 
 
@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <gsAssembler/gsSumFactorization.h>
+
 namespace gismo
 {
 
@@ -46,8 +48,12 @@ public:
                     const gsOptionList & options,
                     gsQuadRule<T>      & rule)
     {
+        // Use sum factorization on tensor-product bases, if requested
+        sumFact.init(basis, options);
+
         // Setup Quadrature (harmless slicing occurs)
-        rule = gsQuadrature::get(basis, options); // harmless slicing occurs here
+        rule = sumFact.enabled() ? sumFact.rule(basis, options)
+                                 : gsQuadrature::get(basis, options); // harmless slicing occurs here
 
         // Set Geometry evaluation flags
         md.flags = NEED_MEASURE;
@@ -66,7 +72,10 @@ public:
         const index_t numActive = actives.rows();
 
         // Evaluate basis functions on element
-        basis.eval_into(md.points, basisData);
+        if ( sumFact.enabled() )
+            sumFact.evaluate(md.points, false);
+        else
+            basis.eval_into(md.points, basisData);
 
         // Compute geometry related values
         geo.computeMap(md);
@@ -79,6 +88,16 @@ public:
     inline void assemble(gsDomainIterator<T>    & ,
                          gsVector<T> const      & quWeights)
     {
+        if ( sumFact.enabled() )
+        {
+            const short_t d = sumFact.dim();
+            coefs.setZero((d+1)*(d+1), md.points.cols());
+            for (index_t k = 0; k < md.points.cols(); ++k) // loop over quadrature nodes
+                coefs(0,k) = sumFact.weight(quWeights,k) * md.measure(k);
+            sumFact.assemble(coefs, localMat);
+            return;
+        }
+
         localMat.noalias() =
             basisData * quWeights.asDiagonal() *
             md.measures.asDiagonal() * basisData.transpose();
@@ -151,6 +170,10 @@ protected:
     gsMatrix<T> localMat;
 
     gsMapData<T> md;
+
+    // Sum factorization data and coefficients
+    gsSumFactorization<T> sumFact;
+    gsMatrix<T> coefs;
 };
 
 
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <gsAssembler/gsQuadrature.h>
+#include <gsAssembler/gsSumFactorization.h>
 
 namespace gismo
 {
@@ -51,8 +52,12 @@ public:
         // Grab right-hand side for current patch
         rhs_ptr = &pde_ptr->rhs()->piece(patchIndex);
 
+        // Use sum factorization on tensor-product bases, if requested
+        sumFact.init(basis, options);
+
         // Setup Quadrature
-        rule = gsQuadrature::get(basis, options); // harmless slicing occurs here
+        rule = sumFact.enabled() ? sumFact.rule(basis, options)
+                                 : gsQuadrature::get(basis, options); // harmless slicing occurs here
 
         // Set Geometry evaluation flags
         md.flags = NEED_VALUE | NEED_MEASURE | NEED_GRAD_TRANSFORM;
@@ -70,7 +75,12 @@ public:
         numActive = actives.rows();
 
         // Evaluate basis functions on element
-        basis.evalAllDers_into( md.points, 1, basisData);
+        if ( sumFact.enabled() )
+        {
+            sumFact.evaluate(md.points, true);
+        }
+        else
+            basis.evalAllDers_into( md.points, 1, basisData);
 
         // Compute image of Gauss nodes under geometry mapping as well as Jacobians
         geo.computeMap(md);
@@ -89,6 +99,30 @@ public:
     inline void assemble(gsDomainIterator<T>    & ,
                          gsVector<T> const      & quWeights)
     {
+        if ( sumFact.enabled() )
+        {
+            const short_t d = sumFact.dim();
+            coefs.setZero((d+1)*(d+1), md.points.cols());
+            rhsCoefs.resize(rhsVals.rows(), md.points.cols());
+            for (index_t k = 0; k < md.points.cols(); ++k) // loop over quadrature nodes
+            {
+                // Multiply weight by the geometry measure
+                const T weight = sumFact.weight(quWeights,k) * md.measure(k);
+
+                // Parametric form of grad(u).grad(v)
+                jacInvTr = md.jacobian(k).cramerInverse().transpose();
+                tmpK.noalias() = jacInvTr.transpose() * jacInvTr;
+                for (short_t b = 0; b != d; ++b)
+                    for (short_t a = 0; a != d; ++a)
+                        coefs(a+1 + (d+1)*(b+1), k) = weight * tmpK(a,b);
+
+                rhsCoefs.col(k) = weight * rhsVals.col(k);
+            }
+            sumFact.assemble(coefs, localMat);
+            sumFact.assembleRhs(rhsCoefs, localRhs);
+            return;
+        }
+
         gsMatrix<T> & bVals  = basisData[0];
         gsMatrix<T> & bGrads = basisData[1];
 
@@ -125,6 +159,7 @@ protected:
     // Basis values
     std::vector<gsMatrix<T> > basisData;
     gsMatrix<T>        physGrad;
+    gsMatrix<T>        jacInvTr, tmpK;
     gsMatrix<index_t> actives;
     index_t numActive;
 
@@ -141,6 +176,10 @@ protected:
     gsMatrix<T> localRhs;
 
     gsMapData<T> md;
+
+    // Sum factorization data and coefficients
+    gsSumFactorization<T> sumFact;
+    gsMatrix<T> coefs, rhsCoefs;
 };
 
 
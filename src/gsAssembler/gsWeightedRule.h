@@ -0,0 +1,254 @@
+/** @file gsWeightedRule.h
+
+    @brief Weighted quadrature rule for tensor-product spline bases
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#pragma once
+
+#include <gsAssembler/gsGaussRule.h>
+#include <gsTensor/gsTensorBasis.h>
+
+namespace gismo
+{
+
+/**
+    \brief Weighted quadrature rule on a tensor-product basis
+
+    In every direction the rule uses a small number of nodes per knot
+    span (\a numNodes on the interior spans, at least \f$p+1\f$ on the
+    \f$p\f$ spans next to the boundary and more on spans where several
+    basis functions start, eg. at repeated knots). For every test
+    function \f$B_i\f$ and every pair of derivative orders
+    \f$a,b\in\{0,1\}\f$ weights \f$w^{ab}_{iq}\f$ are precomputed on
+    the support of \f$B_i\f$, such that
+    \f[ \sum_q w^{ab}_{iq}\, B_j^{(b)}(x_q) = \int B_i^{(a)} B_j^{(b)} \f]
+    holds exactly for all trial functions \f$B_j\f$. The weights
+    contain the test function, they are the minimal norm correction
+    of the Gauss rule values \f$B_i^{(a)}(x_q)\,g_q\f$. See
+
+    F. Calabrò, G. Sangalli, M. Tani, Fast formation of isogeometric
+    Galerkin matrices by weighted quadrature, CMAME 316 (2017).
+
+    The test-dependent weights are used by gsSumFactorization, which
+    then needs roughly two quadrature nodes per direction on each
+    element. The rule cannot be used as a plain gsQuadRule, since no
+    single set of weights integrates the products
+    \f$B_i^{(a)} B_j^{(b)}\f$ exactly; mapTo() raises an error.
+
+    The rule is selected for the sum-factorized visitors by setting
+    the option "quRule" to gsQuadrature::WeightedQuadrature, the
+    option "quWQ" sets \a numNodes.
+
+    \ingroup Assembler
+*/
+template<class T>
+class gsWeightedRule GISMO_FINAL : public gsQuadRule<T>
+{
+public:
+
+    typedef memory::unique_ptr<gsWeightedRule> uPtr;
+    typedef memory::shared_ptr<gsWeightedRule> Ptr;
+
+    /// Default empty constructor
+    gsWeightedRule() { }
+
+    /**
+     * @brief      Constructor
+     *
+     * @param[in]  basis     A tensor-product basis
+     * @param[in]  numNodes  Number of nodes on the interior knot spans
+     */
+    gsWeightedRule(const gsBasis<T> & basis, const index_t numNodes = 2)
+    {
+        std::vector<const gsBasis<T>*> comp;
+        GISMO_ENSURE( tensorComponents(basis, comp),
+                      "Weighted quadrature requires a tensor-product basis.");
+        m_dir.resize(comp.size());
+        for (size_t k = 0; k != comp.size(); ++k)
+            computeUnivariate(*comp[k], numNodes, m_dir[k]);
+    }
+
+    /// Construct a smart-pointer to the rule
+    static uPtr make(const gsBasis<T> & basis, const index_t numNodes = 2)
+    { return uPtr( new gsWeightedRule(basis,numNodes) ); }
+
+    ~gsWeightedRule() { }
+
+public:
+
+    /// \brief Dimension of the rule
+    index_t dim() const { return m_dir.size(); }
+
+    /// Not available, the weights depend on the test function (see
+    /// testWeights())
+    void mapTo( const gsVector<T>&, const gsVector<T>&,
+                gsMatrix<T> &, gsVector<T> & ) const
+    {
+        GISMO_ERROR("gsWeightedRule has test-function dependent weights, "
+                    "use it through gsSumFactorization.");
+    }
+
+    /// Not available, the weights depend on the test function (see
+    /// testWeights())
+    void mapTo( T, T, gsMatrix<T> &, gsVector<T> & ) const
+    {
+        GISMO_ERROR("gsWeightedRule has test-function dependent weights, "
+                    "use it through gsSumFactorization.");
+    }
+
+    /// Index of the knot span in direction \a k which contains \a u
+    index_t elementIndex(const index_t k, const T u) const
+    {
+        const std::vector<T> & br = m_dir[k].breaks;
+        const index_t e = std::upper_bound(br.begin(), br.end(), u) - br.begin() - 1;
+        return math::min(math::max(e,(index_t)0), (index_t)br.size()-2);
+    }
+
+    /// Number of knot spans in direction \a k
+    index_t numElements(const index_t k) const
+    { return m_dir[k].nodes.size(); }
+
+    /// Quadrature nodes on the knot span \a e in direction \a k
+    const gsVector<T> & nodes(const index_t k, const index_t e) const
+    { return m_dir[k].nodes[e]; }
+
+    /// \brief The weights \f$w^{ab}_{iq}\f$ on the knot span \a e in
+    /// direction \a k. Row \a i corresponds to the \a i-th active
+    /// function on the span and column \a q to nodes(k,e)[q]
+    const gsMatrix<T> & testWeights(const index_t k, const index_t e,
+                                    const bool a, const bool b) const
+    { return m_dir[k].W[a+2*b][e]; }
+
+private:
+
+    struct univariate
+    {
+        std::vector<T> breaks;
+        std::vector<gsVector<T> > nodes;
+        std::vector<gsMatrix<T> > W[4];
+    };
+
+    void computeUnivariate(const gsBasis<T> & B, const index_t numNodes,
+                           univariate & R)
+    {
+        const index_t p = B.degree(0);
+
+        R.breaks.clear();
+        typename gsBasis<T>::domainIter domIt = B.makeDomainIterator();
+        for (; domIt->good(); domIt->next() )
+            R.breaks.push_back(domIt->lowerCorner()[0]);
+        R.breaks.push_back(B.support()(0,1));
+        const index_t ne = R.breaks.size() - 1;
+
+        // Quadrature nodes, actives, values and exact Gram matrices per span
+        std::vector<gsMatrix<index_t> > act(ne);
+        std::vector<gsMatrix<T> > V[2], G[4];
+        for (index_t i = 0; i != 2; ++i) V[i].resize(ne);
+        for (index_t i = 0; i != 4; ++i) { G[i].resize(ne); R.W[i].resize(ne); }
+        R.nodes.resize(ne);
+
+        gsGaussRule<T> exact(p+1);
+        std::vector<gsVector<T> > gw(ne);
+        std::vector<gsMatrix<T> > ev;
+        gsMatrix<T> pts;
+        gsVector<T> wts;
+        index_t lastAct = -1;
+        for (index_t e = 0; e != ne; ++e)
+        {
+            const T a = R.breaks[e], b = R.breaks[e+1];
+            pts.resize(1,1);
+            pts(0,0) = (a+b)/2;
+            B.active_into(pts, act[e]);
+
+            // at least one node more than the number of functions
+            // starting on the span (except on the first one)
+            index_t n = math::max(numNodes, act[e].maxCoeff() - lastAct + (e>0));
+            if ( e < p || e >= ne - p )
+                n = math::max(n, p+1);
+            lastAct = act[e].maxCoeff();
+
+            gsGaussRule<T>(n).mapTo(a, b, pts, gw[e]);
+            R.nodes[e] = pts.row(0).transpose();
+            B.evalAllDers_into(pts, 1, ev);
+            V[0][e].swap(ev[0]);
+            V[1][e].swap(ev[1]);
+
+            exact.mapTo(a, b, pts, wts);
+            B.evalAllDers_into(pts, 1, ev);
+            for (index_t s = 0; s != 2; ++s)
+                for (index_t t = 0; t != 2; ++t)
+                    G[s+2*t][e].noalias() = ev[s] * wts.asDiagonal() * ev[t].transpose();
+        }
+
+        // Knot spans (and local index) in the support of each function
+        std::vector<std::vector<std::pair<index_t,index_t> > > supp(B.size());
+        for (index_t e = 0; e != ne; ++e)
+            for (index_t r = 0; r != act[e].rows(); ++r)
+                supp[act[e](r,0)].push_back(std::make_pair(e,r));
+
+        for (index_t s = 0; s != 4; ++s)
+            for (index_t e = 0; e != ne; ++e)
+                R.W[s][e].setZero(act[e].rows(), R.nodes[e].size());
+
+        // Weights of each test function: exactness on all trial
+        // functions, closest to the Gauss rule otherwise
+        gsMatrix<T> A;
+        gsVector<T> r, w0, w;
+        for (size_t i = 0; i != supp.size(); ++i)
+        {
+            if ( supp[i].empty() ) continue;
+            const index_t jmin = act[supp[i].front().first].minCoeff();
+            const index_t jmax = act[supp[i].back ().first].maxCoeff();
+            index_t nq = 0;
+            for (size_t l = 0; l != supp[i].size(); ++l)
+                nq += R.nodes[supp[i][l].first].size();
+
+            for (index_t ta = 0; ta != 2; ++ta)
+                for (index_t tb = 0; tb != 2; ++tb)
+                {
+                    A.setZero(jmax-jmin+1, nq);
+                    r.setZero(jmax-jmin+1);
+                    w0.resize(nq);
+                    index_t c = 0;
+                    for (size_t l = 0; l != supp[i].size(); ++l)
+                    {
+                        const index_t e = supp[i][l].first, row = supp[i][l].second;
+                        const index_t n = R.nodes[e].size();
+                        for (index_t j = 0; j != act[e].rows(); ++j)
+                        {
+                            A.block(act[e](j,0)-jmin, c, 1, n) = V[tb][e].row(j);
+                            r[act[e](j,0)-jmin] += G[ta+2*tb][e](row,j);
+                        }
+                        w0.segment(c,n) = V[ta][e].row(row).transpose().cwiseProduct(gw[e]);
+                        c += n;
+                    }
+
+                    w = w0 + A.completeOrthogonalDecomposition().solve(r - A*w0);
+
+                    c = 0;
+                    for (size_t l = 0; l != supp[i].size(); ++l)
+                    {
+                        const index_t e = supp[i][l].first, n = R.nodes[e].size();
+                        R.W[ta+2*tb][e].row(supp[i][l].second) = w.segment(c,n).transpose();
+                        c += n;
+                    }
+                }
+        }
+    }
+
+private:
+
+    // Univariate rules, one per direction
+    std::vector<univariate> m_dir;
+
+}; // class gsWeightedRule
+
+} // namespace gismo
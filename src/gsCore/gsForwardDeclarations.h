@@ -284,6 +284,7 @@ template <class T=real_t>                class gsGridHierarchy;
 
 template <class T=real_t>                class gsIetiMapper;
 template <class T=real_t>                class gsIetiSystem;
+template <class T=real_t>                class gsDistributedIetiSystem;
 template <class T=real_t>                class gsPrimalSystem;
 template <class T=real_t>                class gsScaledDirichletPrec;
 
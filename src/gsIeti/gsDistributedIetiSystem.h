@@ -0,0 +1,326 @@
+/** @file gsDistributedIetiSystem.h
+
+    @brief This class represents a IETI system whose patches are distributed
+    over the ranks of a MPI communicator
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#pragma once
+
+#include <gsIeti/gsIetiSystem.h>
+#include <gsIeti/gsIetiMapper.h>
+#include <gsMpi/gsMpi.h>
+
+namespace gismo
+{
+
+/** @brief   This class represents a IETI system whose patches are distributed
+ *           over the ranks of a MPI communicator.
+ *
+ *  Every rank only holds the data of the patches it owns and of their
+ *  neighbours, i.e., the patches that share a corner, an edge or a face with
+ *  them (see \ref neighborhood). On this part of the domain, the rank sets up
+ *  the multi-basis, the dof mapper and a \a gsIetiMapper, which yields the
+ *  local dof mappers, the primal constraints and the jump matrices. The
+ *  couplings of the owned patches are the same as for the whole domain, so
+ *  the data for the owned patches agrees with that of a \a gsIetiMapper for
+ *  the whole domain, up to the numbering of the Lagrange multipliers and of
+ *  the primal dofs. Only the geometry (\a gsMultiPatch) and the boundary
+ *  conditions are known on all ranks.
+ *
+ *  The Lagrange multipliers and the primal dofs are identified by the
+ *  patches and the basis functions they act on. Each rank numbers the
+ *  Lagrange multipliers that are \em touched by its patches (i.e., the
+ *  non-zero rows of their jump matrices) locally, ordered by these
+ *  identifiers; all vectors of Lagrange multipliers (like the arguments of
+ *  \ref schurComplement or \ref solve) are given in this local numbering.
+ *  The primal dofs are numbered globally, see \ref primalDofIndices.
+ *
+ *  A Lagrange multiplier that is touched by several ranks is \em shared.
+ *  The values of the shared multipliers are kept consistent: the partial
+ *  results of the ranks are summed up by means of a neighbour-to-neighbour
+ *  exchange (nonblocking sends and receives), see \ref accumulate. The
+ *  contributions are summed up in the order of the ranks, so all ranks
+ *  obtain the same values. Each multiplier is owned by the lowest rank that
+ *  touches it; the owned multipliers are used to compute inner products,
+ *  see \ref dot.
+ *
+ *  The primal problem is solved redundantly: the contributions of the ranks
+ *  to the primal matrix are gathered on all ranks (see \ref addPrimalSubdomain)
+ *  and each rank factorizes the full primal matrix. The jump matrix and the
+ *  right-hand side of the primal problem stay distributed; the products
+ *  \f$ \tilde B_{\Pi}^\top \lambda \f$ are summed up over all ranks.
+ *
+ *  The setup reads as follows (see ieti_mpi_example.cpp):
+ *  \code{.cpp}
+ *      std::vector<index_t> patches = gsDistributedIetiSystem<>::neighborhood( mp, ownedPatches );
+ *      gsDistributedIetiSystem<>::restrictToPatches( mp, bc, patches, mpPart, bcPart );
+ *      // Set up multi-basis mbPart on mpPart and a gsIetiMapper ietiMapper for it,
+ *      // including the primal constraints and the jump matrices
+ *      gsDistributedIetiSystem<> ieti(comm);
+ *      ieti.setupCommunication( ietiMapper, patches, ranks );
+ *      gsPrimalSystem<> primal( ieti.nPrimalDofs() );
+ *      for (k in patches of this rank, numbered as in mpPart)
+ *      {
+ *          gsSparseMatrix<real_t,RowMajor> jumpMatrix = ieti.jumpMatrix(k);
+ *          // Assemble, set up preconditioner and primal problem as for
+ *          // gsIetiSystem, using ieti.primalDofIndices(k)
+ *          ieti.addSubdomain( jumpMatrix.moveToPtr(), makeMatrixOp(localMatrix.moveToPtr()), give(localRhs) );
+ *      }
+ *      ieti.addPrimalSubdomain( primal.jumpMatrix(), primal.localMatrix(), primal.localRhs() );
+ *  \endcode
+ *
+ *  The functions \ref setupCommunication, \ref addPrimalSubdomain,
+ *  \ref accumulate, \ref dot, \ref rhsForSchurComplement,
+ *  \ref constructSolutionFromLagrangeMultipliers, \ref solve,
+ *  \ref globalMultipliers and the application of the operators returned
+ *  by \ref schurComplement and \ref distributedOp are collective, i.e.,
+ *  they have to be called on all ranks.
+ *
+ *  If G+Smo is compiled without MPI, the communicator has just one rank and
+ *  there are no shared multipliers.
+ *
+ *  @ingroup Solver
+**/
+
+template< typename T >
+class gsDistributedIetiSystem
+{
+    typedef gsLinearOperator<T>               Op;              ///< Linear operator
+    typedef memory::shared_ptr<Op>            OpPtr;           ///< Shared pointer to linear operator
+    typedef gsSparseMatrix<T>                 SparseMatrix;    ///< Sparse matrix type
+    typedef gsSparseMatrix<T,RowMajor>        JumpMatrix;      ///< Sparse matrix type for jumps
+    typedef memory::shared_ptr<JumpMatrix>    JumpMatrixPtr;   ///< Shared pointer to sparse matrix type for jumps
+    typedef gsMatrix<T>                       Matrix;          ///< Matrix type
+public:
+
+    /// @brief Constructor
+    ///
+    /// @param comm   The communicator; the object has to outlive this class
+    explicit gsDistributedIetiSystem(const gsMpiComm& comm)
+        : m_comm(comm), m_nLagrangeMultipliers(0), m_nLocalLagrangeMultipliers(0),
+          m_firstOwned(0), m_nPrimalDofs(0), m_nSubdomains(0) {}
+
+    /// @brief Returns the given patches and the patches that share a corner,
+    ///        an edge or a face with one of them (ascending)
+    ///
+    /// @param mp         The whole domain
+    /// @param patches    The indices of the patches of this rank
+    static std::vector<index_t> neighborhood(const gsMultiPatch<T>& mp, const std::vector<index_t>& patches);
+
+    /// @brief Sets up the geometry and the boundary conditions for a part of
+    ///        the domain
+    ///
+    /// @param mp         The whole domain
+    /// @param bc         The boundary conditions on the whole domain
+    /// @param patches    The indices of the patches in the part, ascending
+    /// @param mpPart     The patches in \a patches (numbered in this order)
+    /// @param bcPart     The conditions on their sides that are on the boundary
+    ///                   of the whole domain
+    ///
+    /// The sides of the part that are interfaces of the whole domain carry
+    /// no conditions. If \a patches has been obtained by \ref neighborhood,
+    /// this does not affect the dofs of the patches of this rank.
+    static void restrictToPatches(const gsMultiPatch<T>& mp, const gsBoundaryConditions<T>& bc,
+        const std::vector<index_t>& patches, gsMultiPatch<T>& mpPart, gsBoundaryConditions<T>& bcPart);
+
+    /// @brief Determines the Lagrange multipliers touched by the patches of
+    ///        this rank, their owners, the neighbouring ranks and the numbering
+    ///        of the primal dofs (collective)
+    ///
+    /// @param ietiMapper    The ieti mapper for the part of the domain consisting
+    ///                      of the patches of this rank and their neighbours (see
+    ///                      \ref neighborhood), with the primal constraints and
+    ///                      the jump matrices set up
+    /// @param patches       For every patch of \a ietiMapper, its index in the
+    ///                      whole domain (ascending)
+    /// @param ranks         For every patch of \a ietiMapper, the rank that owns it
+    ///
+    /// The Lagrange multipliers are identified by the (global) indices of the
+    /// patches and the basis functions they connect, the primal dofs by the
+    /// first patch with a constraint for it and the basis functions in the
+    /// support of that constraint. So, the primal constraints have to be given
+    /// by \a gsIetiMapper::cornersAsPrimals or
+    /// \a gsIetiMapper::interfaceAveragesAsPrimals.
+    ///
+    /// If this rank owns no patches, \a patches and \a ranks are empty and
+    /// \a ietiMapper is not used.
+    void setupCommunication(const gsIetiMapper<T>& ietiMapper, const std::vector<index_t>& patches,
+        const std::vector<int>& ranks);
+
+    /// @brief Returns the jump matrix of a patch of this rank, restricted to
+    ///        the Lagrange multipliers touched by this rank (local numbering)
+    ///
+    /// @param k     The index of the patch in the ieti mapper, see \ref setupCommunication
+    const JumpMatrix& jumpMatrix(index_t k) const            { return m_jumpMatrices[k]; }
+
+    /// @brief Returns the global indices of the primal dofs of the primal
+    ///        constraints of a patch of this rank
+    ///
+    /// @param k     The index of the patch in the ieti mapper, see \ref setupCommunication
+    ///
+    /// This replaces \a gsIetiMapper::primalDofIndices for \a gsPrimalSystem.
+    const std::vector<index_t>& primalDofIndices(index_t k) const { return m_primalDofIndices[k]; }
+
+    /// Returns the number of primal dofs (of the whole domain)
+    index_t nPrimalDofs() const                               { return m_nPrimalDofs; }
+
+    /// @brief Adds a new subdomain (a patch owned by this rank)
+    ///
+    /// @param jumpMatrix       The associated jump matrix in local numbering,
+    ///                         see \ref jumpMatrix
+    /// @param localMatrixOp    The operator that represents the local stiffness matrix
+    /// @param localRhs         The contribution to the right-hand side
+    /// @param localSolverOp    The operator that represents a solver for the
+    ///                         local problem. This parameter is optional; the
+    ///                         solver is created automatically if needed.
+    void addSubdomain(JumpMatrixPtr jumpMatrix, OpPtr localMatrixOp,
+        Matrix localRhs, OpPtr localSolverOp = OpPtr())
+    {
+        m_local.addSubdomain(give(jumpMatrix), give(localMatrixOp), give(localRhs), give(localSolverOp));
+        ++m_nSubdomains;
+    }
+
+    /// @brief Adds the contributions of this rank to the primal problem
+    ///        (collective)
+    ///
+    /// @param jumpMatrix       The contribution to the primal jump matrix in
+    ///                         local numbering (as provided by \a gsPrimalSystem
+    ///                         if it was fed with the jump matrices and primal
+    ///                         dof indices of this class)
+    /// @param localMatrix      The contribution to the primal matrix
+    /// @param localRhs         The contribution to the primal right-hand side
+    ///
+    /// The contributions to the primal matrix are summed up over all ranks
+    /// and a sparse Cholesky solver is set up for the result. If the caller
+    /// wants another solver, the member \ref primalSolverOp can be overwritten.
+    ///
+    /// If there are no primal dofs, this function does not need to be called.
+    void addPrimalSubdomain(const JumpMatrix& jumpMatrix, const SparseMatrix& localMatrix,
+        const Matrix& localRhs);
+
+    /// Access the system of the patches owned by this rank
+    gsIetiSystem<T>&       localSystem()                 { return m_local;           }
+    const gsIetiSystem<T>& localSystem() const           { return m_local;           }
+
+    /// Access the primal matrix (summed up over all ranks)
+    const SparseMatrix&    primalMatrix() const          { return m_primalMatrix;    }
+
+    /// Access the solver for the primal problem
+    OpPtr&                 primalSolverOp()              { return m_primalSolverOp;  }
+    const OpPtr&           primalSolverOp() const        { return m_primalSolverOp;  }
+
+    /// Returns the communicator
+    const gsMpiComm&       comm() const                  { return m_comm;            }
+
+    /// Returns the total number of Lagrange multipliers
+    index_t nLagrangeMultipliers() const                 { return m_nLagrangeMultipliers; }
+
+    /// Returns the number of Lagrange multipliers touched by this rank
+    index_t nLocalLagrangeMultipliers() const            { return m_nLocalLagrangeMultipliers; }
+
+    /// Returns the ranks that share Lagrange multipliers with this rank
+    const std::vector<int>& neighbors() const            { return m_neighbors;       }
+
+    /// @brief Sums up the contributions of all ranks to the shared Lagrange
+    ///        multipliers (collective)
+    ///
+    /// @param x  Partial values, in local numbering; overwritten by the sums
+    void accumulate(Matrix& x) const;
+
+    /// @brief Returns the inner product of two consistent vectors of Lagrange
+    ///        multipliers (collective)
+    T dot(const Matrix& a, const Matrix& b) const;
+
+    /// @brief Returns the given vector of Lagrange multipliers in global
+    ///        numbering on all ranks (collective)
+    ///
+    /// The multipliers owned by the ranks are numbered consecutively, in
+    /// the order of the ranks. This is meant for postprocessing; it requires
+    /// the storage for all Lagrange multipliers.
+    Matrix globalMultipliers(const Matrix& x) const;
+
+    /// @brief Returns \a gsLinearOperator that represents the Schur complement
+    ///        for the IETI problem
+    ///
+    /// The application of the operator is collective; it yields consistent
+    /// results if the input is consistent. The operator refers to this object,
+    /// so it must not outlive it.
+    OpPtr schurComplement() const;
+
+    /// @brief Returns \a gsLinearOperator that applies the given operator,
+    ///        which represents the contributions of this rank, and sums up
+    ///        the results by means of \ref accumulate
+    ///
+    /// This allows to use, e.g., the preconditioner from a \a gsScaledDirichletPrec
+    /// which is set up for the patches of this rank. The operator refers to
+    /// this object, so it must not outlive it.
+    OpPtr distributedOp(OpPtr localOp) const;
+
+    /// @brief Returns the right-hand-side that is required for the Schur
+    ///        complement formulation of the IETI problem (collective)
+    Matrix rhsForSchurComplement() const;
+
+    /// @brief Returns the local solutions for the patches owned by this rank
+    ///        (collective)
+    ///
+    /// @param multipliers  The Lagrange multipliers previously computed
+    ///                     (based on the Schur complement form)
+    ///
+    /// If there is a primal problem, its solution is the last entry, so the
+    /// result can be passed to \a gsPrimalSystem::distributePrimalSolution.
+    std::vector<Matrix> constructSolutionFromLagrangeMultipliers(const Matrix& multipliers) const;
+
+    /// @brief Solves the Schur complement formulation of the IETI problem with
+    ///        a preconditioned conjugate gradient method (collective)
+    ///
+    /// @param precond       The preconditioner, as returned by \ref distributedOp
+    /// @param rhs           The right-hand side, see \ref rhsForSchurComplement
+    /// @param multipliers   Initial guess (consistent on all ranks) and result
+    /// @param errorHistory  The relative residuals (in the Euclidean norm),
+    ///                      starting with the initial one
+    /// @param tol           Stopping criterion for the relative residual
+    /// @param maxIter       Maximum number of iterations
+    ///
+    /// @returns  true iff the desired tolerance was reached
+    bool solve(const OpPtr& precond, const Matrix& rhs, Matrix& multipliers,
+        Matrix& errorHistory, T tol = 1e-8, index_t maxIter = 100) const;
+
+private:
+    /// Local contribution of the Schur complement (without accumulation)
+    void applyLocalSchurComplement(const OpPtr& localSchur, const Matrix& input, Matrix& x) const;
+
+    class distributedOp_;
+    class schurComplementOp_;
+
+    const gsMpiComm&                  m_comm;                 ///< The communicator
+    index_t                           m_nLagrangeMultipliers; ///< Total number of Lagrange multipliers
+    index_t                           m_nLocalLagrangeMultipliers; ///< Number of touched multipliers
+    std::vector<index_t>              m_owned;                ///< Local indices of the owned multipliers
+    index_t                           m_firstOwned;           ///< Global index of the first owned multiplier
+    std::vector<int>                  m_neighbors;            ///< Neighbouring ranks, ascending
+    std::vector< std::vector<index_t> > m_shared;             ///< Local indices of the multipliers shared with each neighbour
+    std::vector<JumpMatrix>           m_jumpMatrices;         ///< Jump matrices of the patches of this rank (local numbering)
+    std::vector< std::vector<index_t> > m_primalDofIndices;   ///< Global indices of the primal dofs of the patches of this rank
+    index_t                           m_nPrimalDofs;          ///< Total number of primal dofs
+
+    gsIetiSystem<T>                   m_local;                ///< The patches of this rank
+    index_t                           m_nSubdomains;          ///< Number of patches of this rank
+    JumpMatrix                        m_primalJumpMatrix;     ///< Contribution to the primal jump matrix
+    SparseMatrix                      m_primalMatrix;         ///< The primal matrix
+    Matrix                            m_primalRhs;            ///< Contribution to the primal right-hand side
+    OpPtr                             m_primalSolverOp;       ///< The solver for the primal problem
+};
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsDistributedIetiSystem.hpp)
+#endif
@@ -0,0 +1,571 @@
+/** @file gsDistributedIetiSystem.hpp
+
+    @brief This class represents a IETI system whose patches are distributed
+    over the ranks of a MPI communicator
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#pragma once
+
+#include <gsSolver/gsMatrixOp.h>
+
+namespace gismo
+{
+
+// Applies a local operator (or the local part of the Schur complement)
+// and accumulates the result
+template<class T>
+class gsDistributedIetiSystem<T>::distributedOp_ : public gsLinearOperator<T>
+{
+public:
+    distributedOp_(const gsDistributedIetiSystem<T>* system, OpPtr localOp, bool schur)
+        : m_system(system), m_localOp(give(localOp)), m_schur(schur) {}
+
+    void apply(const gsMatrix<T> & input, gsMatrix<T> & x) const
+    {
+        if (m_schur)
+            m_system->applyLocalSchurComplement(m_localOp, input, x);
+        else if (m_localOp)
+            m_localOp->apply(input, x);
+        else
+            x.setZero(input.rows(), input.cols());
+        m_system->accumulate(x);
+    }
+
+    index_t rows() const { return m_system->nLocalLagrangeMultipliers(); }
+    index_t cols() const { return m_system->nLocalLagrangeMultipliers(); }
+
+private:
+    const gsDistributedIetiSystem<T>* m_system;
+    OpPtr m_localOp;
+    bool m_schur;
+};
+
+template<class T>
+std::vector<index_t> gsDistributedIetiSystem<T>::neighborhood(const gsMultiPatch<T>& mp,
+    const std::vector<index_t>& patches)
+{
+    std::vector<bool> own(mp.nPatches(), false), include(mp.nPatches(), false);
+    for (size_t i=0; i<patches.size(); ++i)
+        own[patches[i]] = include[patches[i]] = true;
+
+    // Every component (corner, edge, face, ...) that belongs to one of the
+    // given patches adds all the patches it belongs to
+    const std::vector< std::vector<patchComponent> > components = mp.allComponents();
+    for (size_t n=0; n<components.size(); ++n)
+    {
+        bool touched = false;
+        for (size_t i=0; i<components[n].size() && !touched; ++i)
+            touched = own[components[n][i].patch()];
+        if (touched)
+            for (size_t i=0; i<components[n].size(); ++i)
+                include[components[n][i].patch()] = true;
+    }
+
+    std::vector<index_t> result;
+    for (size_t k=0; k<include.size(); ++k)
+        if (include[k])
+            result.push_back(k);
+    return result;
+}
+
+template<class T>
+void gsDistributedIetiSystem<T>::restrictToPatches(const gsMultiPatch<T>& mp, const gsBoundaryConditions<T>& bc,
+    const std::vector<index_t>& patches, gsMultiPatch<T>& mpPart, gsBoundaryConditions<T>& bcPart)
+{
+    const index_t nPatches = patches.size();
+    std::vector<index_t> partIndex(mp.nPatches(), -1);
+    mpPart.clear();
+    for (index_t k=0; k<nPatches; ++k)
+    {
+        mpPart.addPatch(mp[patches[k]]);
+        partIndex[patches[k]] = k;
+    }
+    mpPart.computeTopology();
+
+    bcPart.clear();
+    typedef typename gsBoundaryConditions<T>::bcContainer bcContainer;
+    const bcContainer bcAll = bc.allConditions();
+    for (typename bcContainer::const_iterator it = bcAll.begin(); it != bcAll.end(); ++it)
+        if (partIndex[it->patch()] >= 0)
+            bcPart.add(partIndex[it->patch()], it->side(), it->ctype(), it->function(), it->unknown());
+    for (typename gsBoundaryConditions<T>::const_citerator it = bc.cornerBegin(); it != bc.cornerEnd(); ++it)
+        if (partIndex[it->patch] >= 0)
+            bcPart.addCornerValue(it->corner, it->value, partIndex[it->patch], it->unknown);
+}
+
+template<class T>
+void gsDistributedIetiSystem<T>::setupCommunication(const gsIetiMapper<T>& ietiMapper,
+    const std::vector<index_t>& patches, const std::vector<int>& ranks)
+{
+    const index_t nPatches = patches.size();
+    GISMO_ASSERT( (index_t)ranks.size() == nPatches && ( nPatches == 0
+        || (index_t)ietiMapper.dofMapperGlobal().numPatches() == nPatches ),
+        "gsDistributedIetiSystem::setupCommunication: Dimensions do not agree." );
+    GISMO_ASSERT( m_nSubdomains == 0,
+        "gsDistributedIetiSystem::setupCommunication: This has to be called before adding subdomains." );
+
+    const int myRank = m_comm.rank();
+    const int nRanks = m_comm.size();
+
+    // For every free local dof, the index of its basis function
+    std::vector< std::vector<index_t> > basisIndex(nPatches);
+    for (index_t k=0; k<nPatches; ++k)
+    {
+        const gsDofMapper& dm = ietiMapper.dofMapperLocal(k);
+        basisIndex[k].resize(dm.freeSize());
+        const index_t patchSize = dm.patchSize(0);
+        for (index_t i=0; i<patchSize; ++i)
+            if (dm.is_free(i,0))
+                basisIndex[k][dm.index(i,0)] = i;
+    }
+
+    // A Lagrange multiplier is identified by the global indices of the two
+    // patches it acts on and the basis functions on them. The multipliers
+    // touched by this rank are numbered in the order of these keys, which
+    // is the same on all ranks.
+    const index_t nRows = nPatches > 0 ? ietiMapper.jumpMatrix(0).rows() : 0;
+    std::vector< std::vector<index_t> > entries(nRows);
+    std::vector<bool> touched(nRows, false);
+    for (index_t k=0; k<nPatches; ++k)
+    {
+        const JumpMatrix& jm = ietiMapper.jumpMatrix(k);
+        for (index_t r=0; r<jm.outerSize(); ++r)
+            for (typename JumpMatrix::InnerIterator it(jm, r); it; ++it)
+            {
+                entries[r].push_back(k);
+                entries[r].push_back(basisIndex[k][it.col()]);
+                touched[r] = touched[r] || ranks[k] == myRank;
+            }
+    }
+
+    std::vector< std::pair< std::vector<index_t>, index_t > > keys;
+    for (index_t r=0; r<nRows; ++r)
+        if (touched[r])
+        {
+            GISMO_ASSERT( entries[r].size() == 4,
+                "gsDistributedIetiSystem::setupCommunication: Every Lagrange multiplier has to "
+                "act on two patches. Does the ieti mapper cover the neighborhood of the patches "
+                "of this rank?" );
+            std::vector<index_t> key(4);
+            key[0] = patches[entries[r][0]]; key[1] = entries[r][1];
+            key[2] = patches[entries[r][2]]; key[3] = entries[r][3];
+            keys.push_back(std::make_pair(give(key), r));
+        }
+    std::sort(keys.begin(), keys.end());
+
+    const index_t nLocal = keys.size();
+    m_nLocalLagrangeMultipliers = nLocal;
+    m_owned.clear();
+    m_neighbors.clear();
+    m_shared.clear();
+
+    // The lower of the ranks that own the two patches owns the multiplier
+    std::vector<index_t> localIndex(nRows, -1);
+    std::map< int, std::vector<index_t> > shared;
+    for (index_t i=0; i<nLocal; ++i)
+    {
+        const index_t r = keys[i].second;
+        localIndex[r] = i;
+        const int rank1 = ranks[entries[r][0]], rank2 = ranks[entries[r][2]];
+        if (math::min(rank1, rank2) == myRank)
+            m_owned.push_back(i);
+        if (rank1 != myRank)
+            shared[rank1].push_back(i);
+        else if (rank2 != myRank)
+            shared[rank2].push_back(i);
+    }
+    for (typename std::map< int, std::vector<index_t> >::iterator it = shared.begin(); it != shared.end(); ++it)
+    {
+        m_neighbors.push_back(it->first);
+        m_shared.push_back(give(it->second));
+    }
+
+    // The owned multipliers are numbered consecutively in the order of the ranks
+    int nOwned = m_owned.size();
+    std::vector<int> nOwnedPerRank(nRanks);
+    m_comm.allgather(&nOwned, 1, nOwnedPerRank.data());
+    m_firstOwned = 0;
+    m_nLagrangeMultipliers = 0;
+    for (int q=0; q<nRanks; ++q)
+    {
+        if (q == myRank)
+            m_firstOwned = m_nLagrangeMultipliers;
+        m_nLagrangeMultipliers += nOwnedPerRank[q];
+    }
+
+    // Jump matrices of the patches of this rank in local numbering
+    m_jumpMatrices.clear();
+    m_jumpMatrices.resize(nPatches);
+    for (index_t k=0; k<nPatches; ++k)
+        if (ranks[k] == myRank)
+        {
+            const JumpMatrix& jm = ietiMapper.jumpMatrix(k);
+            gsSparseEntries<T> triplets;
+            triplets.reserve(jm.nonZeros());
+            for (index_t r=0; r<jm.outerSize(); ++r)
+                for (typename JumpMatrix::InnerIterator it(jm, r); it; ++it)
+                    triplets.add(localIndex[r], it.col(), it.value());
+            m_jumpMatrices[k].resize(nLocal, jm.cols());
+            m_jumpMatrices[k].setFrom(triplets);
+        }
+
+    // A primal dof is identified by the first patch with a constraint for it
+    // and the basis functions in the support of that constraint. The keys
+    // of the primal dofs of the patches of all ranks are gathered to obtain
+    // the global numbering.
+    const index_t nPrimalLocal = ietiMapper.nPrimalDofs();
+    std::vector<index_t> firstPatch(nPrimalLocal, -1), firstConstraint(nPrimalLocal, -1);
+    std::vector<bool> primalTouched(nPrimalLocal, false);
+    for (index_t k=0; k<nPatches; ++k)
+    {
+        const std::vector<index_t>& idx = ietiMapper.primalDofIndices(k);
+        for (size_t j=0; j<idx.size(); ++j)
+        {
+            if (firstPatch[idx[j]] < 0)
+            {
+                firstPatch[idx[j]] = k;
+                firstConstraint[idx[j]] = j;
+            }
+            primalTouched[idx[j]] = primalTouched[idx[j]] || ranks[k] == myRank;
+        }
+    }
+
+    std::vector< std::vector<index_t> > primalKeys(nPrimalLocal);
+    std::vector<index_t> buffer;
+    for (index_t i=0; i<nPrimalLocal; ++i)
+        if (primalTouched[i])
+        {
+            const index_t k = firstPatch[i];
+            const gsSparseVector<T>& constr = ietiMapper.primalConstraints(k)[firstConstraint[i]];
+            std::vector<index_t>& key = primalKeys[i];
+            key.push_back(patches[k]);
+            for (typename gsSparseVector<T>::InnerIterator it(constr); it; ++it)
+                key.push_back(basisIndex[k][it.index()]);
+            std::sort(key.begin()+1, key.end());
+            buffer.push_back(key.size());
+            buffer.insert(buffer.end(), key.begin(), key.end());
+        }
+
+    int bufferSize = buffer.size();
+    std::vector<int> counts(nRanks), displ(nRanks+1, 0);
+    m_comm.allgather(&bufferSize, 1, counts.data());
+    for (int q=0; q<nRanks; ++q)
+        displ[q+1] = displ[q] + counts[q];
+    std::vector<index_t> allBuffers(displ[nRanks]);
+    m_comm.allgatherv(buffer.data(), bufferSize, allBuffers.data(), counts.data(), displ.data());
+
+    std::vector< std::vector<index_t> > allKeys;
+    for (index_t j=0; j<displ[nRanks]; j+=allBuffers[j]+1)
+        allKeys.push_back(std::vector<index_t>(allBuffers.begin()+j+1, allBuffers.begin()+j+1+allBuffers[j]));
+    std::sort(allKeys.begin(), allKeys.end());
+    allKeys.erase(std::unique(allKeys.begin(), allKeys.end()), allKeys.end());
+    m_nPrimalDofs = allKeys.size();
+
+    m_primalDofIndices.clear();
+    m_primalDofIndices.resize(nPatches);
+    for (index_t k=0; k<nPatches; ++k)
+        if (ranks[k] == myRank)
+        {
+            const std::vector<index_t>& idx = ietiMapper.primalDofIndices(k);
+            for (size_t j=0; j<idx.size(); ++j)
+                m_primalDofIndices[k].push_back(
+                    std::lower_bound(allKeys.begin(), allKeys.end(), primalKeys[idx[j]]) - allKeys.begin() );
+        }
+}
+
+template<class T>
+void gsDistributedIetiSystem<T>::addPrimalSubdomain(const JumpMatrix& jumpMatrix,
+    const SparseMatrix& localMatrix, const Matrix& localRhs)
+{
+    const index_t nPrimal = localMatrix.rows();
+    const index_t nLocal = nLocalLagrangeMultipliers();
+
+    m_primalJumpMatrix = jumpMatrix;
+    if (m_primalJumpMatrix.rows() == 0 && m_primalJumpMatrix.cols() == 0) // no patches on this rank
+        m_primalJumpMatrix.resize(nLocal, nPrimal);
+    m_primalRhs = localRhs;
+
+    GISMO_ASSERT( m_primalJumpMatrix.rows() == nLocal && m_primalJumpMatrix.cols() == nPrimal
+        && localMatrix.cols() == nPrimal && m_primalRhs.rows() == nPrimal,
+        "gsDistributedIetiSystem::addPrimalSubdomain: Dimensions do not agree." );
+
+    // Gather the contributions to the primal matrix on all ranks
+    std::vector<index_t> rows, cols;
+    std::vector<T> values;
+    rows.reserve(localMatrix.nonZeros());
+    cols.reserve(localMatrix.nonZeros());
+    values.reserve(localMatrix.nonZeros());
+    for (index_t i=0; i<localMatrix.outerSize(); ++i)
+        for (typename SparseMatrix::InnerIterator it(localMatrix, i); it; ++it)
+        {
+            rows.push_back(it.row());
+            cols.push_back(it.col());
+            values.push_back(it.value());
+        }
+
+    const int nRanks = m_comm.size();
+    int nnz = values.size();
+    std::vector<int> counts(nRanks), displ(nRanks+1, 0);
+    m_comm.allgather(&nnz, 1, counts.data());
+    for (int q=0; q<nRanks; ++q)
+        displ[q+1] = displ[q] + counts[q];
+
+    std::vector<index_t> allRows(displ[nRanks]), allCols(displ[nRanks]);
+    std::vector<T> allValues(displ[nRanks]);
+    m_comm.allgatherv(rows.data(), nnz, allRows.data(), counts.data(), displ.data());
+    m_comm.allgatherv(cols.data(), nnz, allCols.data(), counts.data(), displ.data());
+    m_comm.allgatherv(values.data(), nnz, allValues.data(), counts.data(), displ.data());
+
+    // Since all ranks sum up the same triplets in the same order, they
+    // obtain the same primal matrix
+    gsSparseEntries<T> triplets;
+    triplets.reserve(displ[nRanks]);
+    for (int j=0; j<displ[nRanks]; ++j)
+        triplets.add(allRows[j], allCols[j], allValues[j]);
+
+    m_primalMatrix.clear();
+    m_primalMatrix.resize(nPrimal, nPrimal);
+    m_primalMatrix.setFrom(triplets);
+    m_primalMatrix.makeCompressed();
+
+    m_primalSolverOp = makeSparseCholeskySolver(m_primalMatrix);
+}
+
+template<class T>
+void gsDistributedIetiSystem<T>::accumulate(Matrix& x) const
+{
+    GISMO_ASSERT( x.rows() == nLocalLagrangeMultipliers(),
+        "gsDistributedIetiSystem::accumulate: Dimensions do not agree." );
+
+    if (m_neighbors.empty()) return;
+
+#ifdef GISMO_WITH_MPI
+    const int myRank = m_comm.rank();
+    const index_t nn = m_neighbors.size();
+    const index_t cols = x.cols();
+    const int tag = 2310;
+
+    std::vector<Matrix> sendBuf(nn), recvBuf(nn);
+    std::vector<MPI_Request> requests(2*nn);
+    for (index_t q=0; q<nn; ++q)
+    {
+        const std::vector<index_t>& idx = m_shared[q];
+        const index_t sz = idx.size();
+        recvBuf[q].resize(sz, cols);
+        m_comm.irecv(recvBuf[q].data(), recvBuf[q].size(), m_neighbors[q], &requests[q], tag);
+        sendBuf[q].resize(sz, cols);
+        for (index_t i=0; i<sz; ++i)
+            sendBuf[q].row(i) = x.row(idx[i]);
+        m_comm.isend(sendBuf[q].data(), sendBuf[q].size(), m_neighbors[q], &requests[nn+q], tag);
+    }
+    MPI_Waitall(2*nn, requests.data(), MPI_STATUSES_IGNORE);
+
+    // The contributions are summed up in the order of the ranks, so all
+    // ranks obtain exactly the same values. The own contributions are
+    // still available in the send buffers.
+    const index_t firstHigher = std::lower_bound(m_neighbors.begin(), m_neighbors.end(), myRank) - m_neighbors.begin();
+    if (firstHigher > 0)
+    {
+        for (index_t q=0; q<nn; ++q)
+            for (size_t i=0; i<m_shared[q].size(); ++i)
+                x.row(m_shared[q][i]).setZero();
+        for (index_t q=0; q<firstHigher; ++q)
+            for (size_t i=0; i<m_shared[q].size(); ++i)
+                x.row(m_shared[q][i]) += recvBuf[q].row(i);
+        std::vector<bool> restored(x.rows(), false);
+        for (index_t q=0; q<nn; ++q)
+            for (size_t i=0; i<m_shared[q].size(); ++i)
+                if (!restored[m_shared[q][i]])
+                {
+                    x.row(m_shared[q][i]) += sendBuf[q].row(i);
+                    restored[m_shared[q][i]] = true;
+                }
+    }
+    for (index_t q=firstHigher; q<nn; ++q)
+        for (size_t i=0; i<m_shared[q].size(); ++i)
+            x.row(m_shared[q][i]) += recvBuf[q].row(i);
+#else
+    GISMO_UNUSED(x);
+#endif
+}
+
+template<class T>
+T gsDistributedIetiSystem<T>::dot(const Matrix& a, const Matrix& b) const
+{
+    GISMO_ASSERT( a.rows() == nLocalLagrangeMultipliers() && b.rows() == a.rows() && b.cols() == a.cols(),
+        "gsDistributedIetiSystem::dot: Dimensions do not agree." );
+    T result = 0;
+    const index_t sz = m_owned.size();
+    for (index_t i=0; i<sz; ++i)
+        result += a.row(m_owned[i]).dot(b.row(m_owned[i]));
+    return m_comm.sum(result);
+}
+
+template<class T>
+typename gsDistributedIetiSystem<T>::Matrix
+gsDistributedIetiSystem<T>::globalMultipliers(const Matrix& x) const
+{
+    Matrix result;
+    result.setZero(m_nLagrangeMultipliers, x.cols());
+    const index_t sz = m_owned.size();
+    for (index_t i=0; i<sz; ++i)
+        result.row(m_firstOwned + i) = x.row(m_owned[i]);
+    m_comm.sum(result.data(), result.size());
+    return result;
+}
+
+template<class T>
+void gsDistributedIetiSystem<T>::applyLocalSchurComplement(const OpPtr& localSchur,
+    const Matrix& input, Matrix& x) const
+{
+    // The contributions to the primal problem are summed up while the local
+    // problems are solved
+    Matrix primal;
+#ifdef GISMO_WITH_MPI
+    MPI_Request request = MPI_REQUEST_NULL;
+#endif
+    if (m_primalSolverOp)
+    {
+        primal = m_primalJumpMatrix.transpose() * input;
+#ifdef GISMO_WITH_MPI
+        m_comm.isum(primal.data(), primal.size(), &request);
+#else
+        m_comm.sum(primal.data(), primal.size());
+#endif
+    }
+
+    if (localSchur)
+        localSchur->apply(input, x);
+    else
+        x.setZero(input.rows(), input.cols());
+
+    if (m_primalSolverOp)
+    {
+#ifdef GISMO_WITH_MPI
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+#endif
+        Matrix tmp;
+        m_primalSolverOp->apply(primal, tmp);
+        x += m_primalJumpMatrix * tmp;
+    }
+}
+
+template<class T>
+typename gsDistributedIetiSystem<T>::OpPtr gsDistributedIetiSystem<T>::schurComplement() const
+{
+    return OpPtr( new distributedOp_(this, m_nSubdomains>0 ? m_local.schurComplement() : OpPtr(), true) );
+}
+
+template<class T>
+typename gsDistributedIetiSystem<T>::OpPtr gsDistributedIetiSystem<T>::distributedOp(OpPtr localOp) const
+{
+    return OpPtr( new distributedOp_(this, give(localOp), false) );
+}
+
+template<class T>
+gsMatrix<T> gsDistributedIetiSystem<T>::rhsForSchurComplement() const
+{
+    Matrix result;
+    if (m_nSubdomains>0)
+        result = m_local.rhsForSchurComplement();
+    else
+        result.setZero(nLocalLagrangeMultipliers(), m_primalSolverOp ? m_primalRhs.cols() : 1);
+
+    if (m_primalSolverOp)
+    {
+        Matrix primalRhs = m_primalRhs, tmp;
+        m_comm.sum(primalRhs.data(), primalRhs.size());
+        m_primalSolverOp->apply(primalRhs, tmp);
+        result += m_primalJumpMatrix * tmp;
+    }
+
+    accumulate(result);
+    return result;
+}
+
+template<class T>
+std::vector< gsMatrix<T> > gsDistributedIetiSystem<T>::constructSolutionFromLagrangeMultipliers(const Matrix& multipliers) const
+{
+    std::vector<Matrix> result;
+    if (m_nSubdomains>0)
+        result = m_local.constructSolutionFromLagrangeMultipliers(multipliers);
+
+    if (m_primalSolverOp)
+    {
+        Matrix primalRhs = m_primalRhs - m_primalJumpMatrix.transpose() * multipliers, tmp;
+        m_comm.sum(primalRhs.data(), primalRhs.size());
+        m_primalSolverOp->apply(primalRhs, tmp);
+        result.push_back(give(tmp));
+    }
+    return result;
+}
+
+template<class T>
+bool gsDistributedIetiSystem<T>::solve(const OpPtr& precond, const Matrix& rhs, Matrix& multipliers,
+    Matrix& errorHistory, T tol, index_t maxIter) const
+{
+    GISMO_ASSERT( rhs.rows() == nLocalLagrangeMultipliers() && rhs.cols() == 1
+        && multipliers.rows() == rhs.rows() && multipliers.cols() == 1,
+        "gsDistributedIetiSystem::solve: Dimensions do not agree." );
+
+    const OpPtr schur = schurComplement();
+    const index_t sz = m_owned.size();
+
+    Matrix residual, update, direction, tmp;
+    schur->apply(multipliers, tmp);
+    residual = rhs - tmp;
+    precond->apply(residual, update);
+
+    // The two inner products of an iteration are summed up by one reduction
+    T dots[3] = { 0, 0, 0 }; // <rhs,rhs>, <r,r>, <r,z>
+    for (index_t i=0; i<sz; ++i)
+    {
+        const index_t k = m_owned[i];
+        dots[0] += rhs(k,0) * rhs(k,0);
+        dots[1] += residual(k,0) * residual(k,0);
+        dots[2] += residual(k,0) * update(k,0);
+    }
+    m_comm.sum(dots, 3);
+
+    const T rhsNorm = dots[0] > 0 ? math::sqrt(dots[0]) : (T)1;
+    std::vector<T> history(1, math::sqrt(dots[1]) / rhsNorm);
+    T rz = dots[2];
+    direction = update;
+
+    for (index_t it=0; it<maxIter && history.back()>=tol; ++it)
+    {
+        schur->apply(direction, tmp);
+        const T alpha = rz / dot(direction, tmp);
+        multipliers.noalias() += alpha * direction;
+        residual.noalias() -= alpha * tmp;
+        precond->apply(residual, update);
+
+        dots[0] = dots[1] = 0;
+        for (index_t i=0; i<sz; ++i)
+        {
+            const index_t k = m_owned[i];
+            dots[0] += residual(k,0) * residual(k,0);
+            dots[1] += residual(k,0) * update(k,0);
+        }
+        m_comm.sum(dots, 2);
+
+        history.push_back(math::sqrt(dots[0]) / rhsNorm);
+        const T beta = dots[1] / rz;
+        rz = dots[1];
+        direction = update + beta * direction;
+    }
+
+    errorHistory.resize(history.size(), 1);
+    std::copy(history.begin(), history.end(), errorHistory.data());
+    return history.back() < tol;
+}
+
+} // namespace gismo
@@ -0,0 +1,9 @@
+#include <gsIeti/gsDistributedIetiSystem.h>
+#include <gsIeti/gsDistributedIetiSystem.hpp>
+
+namespace gismo
+{
+
+CLASS_TEMPLATE_INST gsDistributedIetiSystem<real_t>;
+
+}
@@ -62,6 +62,10 @@ namespace gismo
  *
  *  The right-hand sides are stored in a vector accessible via \ref localRhs.
  *
+ *  The local solvers are set up and applied concurrently (OpenMP), where the
+ *  largest subdomains are handled first. So, the local solvers provided by
+ *  the caller must not share any state.
+ *
  *  @ingroup Solver
 **/
 
@@ -75,6 +79,7 @@ class gsIetiSystem
     typedef gsSparseMatrix<T,RowMajor>        JumpMatrix;      ///< Sparse matrix type for jumps
     typedef memory::shared_ptr<JumpMatrix>    JumpMatrixPtr;   ///< Shared pointer to sparse matrix type for jumps
     typedef gsMatrix<T>                       Matrix;          ///< Matrix type
+    typedef gsSolverOp<typename gsSparseSolver<T>::LU> LUSolverOp; ///< Sparse LU solver as operator
 public:
 
     /// @brief Reserves the memory required to store the number of subdomains
@@ -143,6 +148,19 @@ public:
     /// them from the \ref localMatrixOp if they are \a gsMatrixOp<gsSparseMatrix<T>>
     std::vector<Matrix> constructSolutionFromLagrangeMultipliers(const Matrix& multipliers) const;
 
+    /// @brief Recomputes the local solvers that have been created automatically
+    ///        after the values of the local matrices have changed
+    ///
+    /// This requires that the sparsity patterns of the local matrices (as
+    /// provided by \ref localMatrixOp) have not changed; then only the
+    /// numerical factorizations are recomputed, the symbolic factorizations
+    /// (ordering and elimination tree) are reused. The local solvers provided
+    /// by the caller are not touched.
+    ///
+    /// If only the right-hand sides have changed, this function does not
+    /// need to be called since the factorizations are kept anyway.
+    void refactorizeLocalSolvers();
+
     /// @brief Returns \a gsLinearOperator that represents the IETI problem as
     ///        saddle point problem
     OpPtr saddlePointProblem() const;
@@ -159,11 +177,13 @@ public:
 
 private:
     void setupSparseLUSolvers() const;                ///< Setup solvers if not provided by user
+    std::vector<index_t> largestFirst() const;        ///< Subdomain indices, ordered by decreasing size
 
     std::vector<JumpMatrixPtr>  m_jumpMatrices;       ///< Stores the jump matrices
     std::vector<OpPtr>          m_localMatrixOps;     ///< Stores the local matrix ops \f$ \tilde A_k \f$
     std::vector<Matrix>         m_localRhs;           ///< Stores the local right-hand sides
     mutable std::vector<OpPtr>  m_localSolverOps;     ///< Stores the local solvers
+    mutable std::vector< memory::shared_ptr<LUSolverOp> > m_localFactorizations; ///< The local solvers that have been created automatically
 };
 
 } // namespace gismo
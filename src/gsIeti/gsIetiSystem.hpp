@@ -25,6 +25,7 @@ void gsIetiSystem<T>::reserve(index_t n)
     this->m_localMatrixOps.reserve(n);
     this->m_localRhs.reserve(n);
     this->m_localSolverOps.reserve(n);
+    this->m_localFactorizations.reserve(n);
     this->m_jumpMatrices.reserve(n);
 }
 
@@ -44,26 +45,84 @@ void gsIetiSystem<T>::addSubdomain(JumpMatrixPtr jumpMatrix, OpPtr localMatrixOp
     this->m_localMatrixOps.push_back(give(localMatrixOp));
     this->m_localRhs.push_back(give(localRhs));
     this->m_localSolverOps.push_back(give(localSolverOp));
+    this->m_localFactorizations.push_back(memory::shared_ptr<LUSolverOp>());
+}
+
+template<class T>
+std::vector<index_t> gsIetiSystem<T>::largestFirst() const
+{
+    const index_t sz = this->m_localMatrixOps.size();
+    std::vector< std::pair<index_t,index_t> > sizes(sz); // (-size, index)
+    for (index_t i=0; i<sz; ++i)
+        sizes[i] = std::make_pair( -this->m_localMatrixOps[i]->rows(), i );
+    std::sort(sizes.begin(), sizes.end());
+    std::vector<index_t> result(sz);
+    for (index_t i=0; i<sz; ++i)
+        result[i] = sizes[i].second;
+    return result;
 }
 
 template<class T>
 void gsIetiSystem<T>::setupSparseLUSolvers() const
 {
-    const size_t sz = this->m_localSolverOps.size();
-    for (size_t i=0; i<sz; ++i)
+    const index_t sz = this->m_localSolverOps.size();
+    std::vector<const SparseMatrixOp*> matops(sz, NULL);
+    bool missing = false;
+    for (index_t i=0; i<sz; ++i)
     {
         if (!m_localSolverOps[i]) // If not yet provided...
         {
-            SparseMatrixOp* matop = dynamic_cast<SparseMatrixOp*>(this->m_localMatrixOps[i].get());
-            GISMO_ENSURE( matop, "gsIetiSystem::setupSparseLUSolvers The local solvers can only "
+            matops[i] = dynamic_cast<const SparseMatrixOp*>(this->m_localMatrixOps[i].get());
+            GISMO_ENSURE( matops[i], "gsIetiSystem::setupSparseLUSolvers The local solvers can only "
               "be computed on the fly if the local systems in localMatrixOps are of type "
               "gsMatrixOp<gsSparseMatrix<T>>. Please provide solvers via members .addSubdomain "
               "or .solverOp" );
-            this->m_localSolverOps[i] = makeSparseLUSolver(SparseMatrix(matop->matrix()));
+            missing = true;
+        }
+    }
+    if (!missing) return;
+
+    // The factorizations are independent; the largest ones are started first
+    const std::vector<index_t> order = largestFirst();
+#   pragma omp parallel for schedule(dynamic,1)
+    for (index_t k=0; k<sz; ++k)
+    {
+        const index_t i = order[k];
+        if (matops[i])
+        {
+            this->m_localFactorizations[i] = makeSparseLUSolver(SparseMatrix(matops[i]->matrix()));
+            this->m_localSolverOps[i] = this->m_localFactorizations[i];
         }
     }
 }
 
+template<class T>
+void gsIetiSystem<T>::refactorizeLocalSolvers()
+{
+    const index_t sz = this->m_localSolverOps.size();
+    std::vector<const SparseMatrixOp*> matops(sz, NULL);
+    for (index_t i=0; i<sz; ++i)
+    {
+        // Only the solvers that have been created by setupSparseLUSolvers
+        // and have not been replaced by the caller afterwards
+        if (this->m_localFactorizations[i] && this->m_localSolverOps[i] == this->m_localFactorizations[i])
+        {
+            matops[i] = dynamic_cast<const SparseMatrixOp*>(this->m_localMatrixOps[i].get());
+            GISMO_ENSURE( matops[i], "gsIetiSystem::refactorizeLocalSolvers The local solvers can only "
+              "be recomputed if the local systems in localMatrixOps are of type gsMatrixOp<gsSparseMatrix<T>>." );
+        }
+    }
+
+    const std::vector<index_t> order = largestFirst();
+#   pragma omp parallel for schedule(dynamic,1)
+    for (index_t k=0; k<sz; ++k)
+    {
+        const index_t i = order[k];
+        if (matops[i])
+            this->m_localFactorizations[i]->factorize(SparseMatrix(matops[i]->matrix()));
+    }
+}
+
 template<class T>
 typename gsIetiSystem<T>::OpPtr gsIetiSystem<T>::saddlePointProblem() const
 {
@@ -83,7 +142,10 @@ template<class T>
 typename gsIetiSystem<T>::OpPtr gsIetiSystem<T>::schurComplement() const
 {
     setupSparseLUSolvers();
-    return gsAdditiveOp<T>::make( this->m_jumpMatrices, this->m_localSolverOps );
+    // The local solvers are distinct objects, they can be applied concurrently
+    typename gsAdditiveOp<T>::Ptr result = gsAdditiveOp<T>::make( this->m_jumpMatrices, this->m_localSolverOps );
+    result->setParallel();
+    return result;
 }
 
 
@@ -91,15 +153,20 @@ template<class T>
 gsMatrix<T> gsIetiSystem<T>::rhsForSchurComplement() const
 {
     setupSparseLUSolvers();
-    Matrix result;
-    result.setZero( this->nLagrangeMultipliers(), this->m_localRhs[0].cols());
     const index_t numPatches = this->m_jumpMatrices.size();
-    for (index_t i=0; i<numPatches; ++i)
+    const std::vector<index_t> order = largestFirst();
+    std::vector<Matrix> tmp(numPatches);
+#   pragma omp parallel for schedule(dynamic,1)
+    for (index_t k=0; k<numPatches; ++k)
     {
-        Matrix tmp;
-        this->m_localSolverOps[i]->apply( this->m_localRhs[i], tmp );
-        result += *(this->m_jumpMatrices[i]) * tmp;
+        const index_t i = order[k];
+        this->m_localSolverOps[i]->apply( this->m_localRhs[i], tmp[i] );
     }
+
+    Matrix result;
+    result.setZero( this->nLagrangeMultipliers(), this->m_localRhs[0].cols());
+    for (index_t i=0; i<numPatches; ++i)
+        result += *(this->m_jumpMatrices[i]) * tmp[i];
     return result;
 }
 
@@ -109,10 +176,13 @@ std::vector< gsMatrix<T> > gsIetiSystem<T>::constructSolutionFromLagrangeMultipl
     setupSparseLUSolvers();
 
     const index_t numPatches = this->m_jumpMatrices.size();
+    const std::vector<index_t> order = largestFirst();
     std::vector<Matrix> result;
     result.resize(numPatches);
-    for (index_t i=0; i<numPatches; ++i)
+#   pragma omp parallel for schedule(dynamic,1)
+    for (index_t k=0; k<numPatches; ++k)
     {
+        const index_t i = order[k];
         this->m_localSolverOps[i]->apply( this->m_localRhs[i]-this->m_jumpMatrices[i]->transpose()*multipliers, result[i] );
     }
     return result;
@@ -83,8 +83,19 @@ class gsScaledDirichletPrec
     typedef gsSparseMatrix<T,RowMajor>        JumpMatrix;      ///< Sparse matrix type for jumps
     typedef memory::shared_ptr<JumpMatrix>    JumpMatrixPtr;   ///< Shared pointer to sparse matrix type for jumps
     typedef gsMatrix<T>                       Matrix;          ///< Matrix type
+    typedef gsSolverOp<typename gsSparseSolver<T>::SimplicialLDLT> CholeskySolverOp; ///< Sparse Cholesky solver as operator
 public:
 
+    /// @brief The data that is kept for a local Schur complement that has been
+    ///        set up from the local stiffness matrix, see \ref addSubdomain
+    struct LocalFactorization
+    {
+        std::vector<index_t>                  dofs;            ///< The skeleton dofs
+        memory::shared_ptr<SparseMatrix>      A00, A01, A10;   ///< The blocks as from \ref matrixBlocks, where A01 is negated
+        memory::shared_ptr<CholeskySolverOp>  solver;          ///< The factorization of the block A11
+        memory::shared_ptr<Matrix>            dense;           ///< The assembled Schur complement, if set up
+    };
+
     /// @brief Reserves the memory required to store the given number of subdomain
     /// @param n Number of subdomains
     void reserve( index_t n )
@@ -92,6 +103,7 @@ public:
         m_jumpMatrices.reserve(n);
         m_localSchurOps.reserve(n);
         m_localScaling.reserve(n);
+        m_localFactorizations.reserve(n);
     }
 
     /// @briefs Adds a new subdomain
@@ -109,6 +121,7 @@ public:
         m_jumpMatrices.push_back(give(jumpMatrix));
         m_localSchurOps.push_back(give(localSchurOp));
         m_localScaling.push_back(Matrix());
+        m_localFactorizations.push_back(LocalFactorization());
     }
 
     // Adds a new subdomain
@@ -116,6 +129,37 @@ public:
     void addSubdomain( std::pair<JumpMatrix,OpPtr> data )
     { addSubdomain(data.first.moveToPtr(), give(data.second)); }
 
+    /// @brief Adds a new subdomain, where the jump matrix and the local
+    ///        stiffness matrix are restricted to the skeleton
+    ///
+    /// @param jumpMatrix    The jump matrix
+    /// @param localMatrix   The local stiffness matrix
+    /// @param dofs          The degrees of freedom on the skeleton
+    ///
+    /// This is equivalent to passing the result of \ref restrictToSkeleton to
+    /// \ref addSubdomain. Additionally, the factorization is kept, which allows
+    /// to update the local Schur complement using \ref updateLocalMatrix.
+    void addSubdomain( const JumpMatrix& jumpMatrix, const SparseMatrix& localMatrix,
+        std::vector<index_t> dofs );
+
+    /// @brief Updates the local Schur complement for new values of the local
+    ///        stiffness matrix
+    ///
+    /// @param k             The index of the subdomain
+    /// @param localMatrix   The local stiffness matrix
+    ///
+    /// This requires that the subdomain has been added using the variant of
+    /// \ref addSubdomain that takes the local stiffness matrix and that the
+    /// sparsity pattern of the local stiffness matrix has not changed. Only the
+    /// numerical factorization is recomputed; the symbolic factorization
+    /// (ordering and elimination tree) is reused. The operators returned by
+    /// \ref localSchurOps and by \ref preconditioner before the update
+    /// reflect the new values. If the local Schur complement has been assembled
+    /// by \ref setupDenseSchurComplements, it is re-assembled.
+    ///
+    /// Different subdomains can be updated concurrently.
+    void updateLocalMatrix( index_t k, const SparseMatrix& localMatrix );
+
     /// Access the jump matrix
     JumpMatrixPtr&       jumpMatrix(index_t k)           { return m_jumpMatrices[k];  }
     const JumpMatrixPtr& jumpMatrix(index_t k) const     { return m_jumpMatrices[k];  }
@@ -215,15 +259,38 @@ public:
     /// This requires that the subdomains have been defined first.
     void setupMultiplicityScaling();
 
+    /// @brief Replaces the local Schur complements of the small subdomains by
+    ///        assembled dense matrices
+    ///
+    /// @param maxSkeletonDofs  Only subdomains with at most that many skeleton
+    ///                         dofs are considered
+    ///
+    /// Applying a dense Schur complement is a matrix-matrix product instead
+    /// of a sparse solve; if \ref preconditioner is applied to several
+    /// vectors at once, these are handled by one product. For subdomains that
+    /// have been added using the variant of \ref addSubdomain taking the local
+    /// stiffness matrix, the dense matrix is computed from the kept blocks and
+    /// factorization. Otherwise, the local Schur complement operator is
+    /// applied to the identity matrix. The subdomains are handled concurrently.
+    ///
+    /// This requires that the subdomains have been defined first. Operators
+    /// obtained from \ref preconditioner before this call are not affected.
+    void setupDenseSchurComplements( index_t maxSkeletonDofs = 500 );
+
     /// @brief This returns the preconditioner as \a gsLinearOperator
     ///
     /// This requires that the subdomains have been defined first.
     OpPtr preconditioner() const;
 
+private:
+    /// Assembles the Schur complement from the kept blocks and factorization
+    static void denseSchurComplement( const LocalFactorization& data, Matrix& result );
+
 public:
     std::vector<JumpMatrixPtr>  m_jumpMatrices;     ///< The jump matrices \f$ \hat B_k \f$
     std::vector<OpPtr>          m_localSchurOps;    ///< The local Schur complements \f$ S_k \f$
     std::vector<Matrix>         m_localScaling;     ///< The diagonal entries of \f$ D_k \f$ as vectors
+    std::vector<LocalFactorization> m_localFactorizations; ///< The factorizations, if kept
 };
 
 } // namespace gismo
@@ -145,6 +145,104 @@ gsScaledDirichletPrec<T>::schurComplement( Blocks matrixBlocks, OpPtr solver )
     );
 }
 
+template <class T>
+void gsScaledDirichletPrec<T>::addSubdomain( const JumpMatrix& jumpMatrix, const SparseMatrix& localMatrix,
+    std::vector<index_t> dofs )
+{
+    Blocks blocks = matrixBlocks(localMatrix, dofs);
+    blocks.A01 *= -1;
+
+    LocalFactorization data;
+    data.A00 = blocks.A00.moveToPtr();
+    data.A01 = blocks.A01.moveToPtr();
+    data.A10 = blocks.A10.moveToPtr();
+    data.solver = makeSparseCholeskySolver(blocks.A11);
+
+    addSubdomain(
+        restrictJumpMatrix(jumpMatrix, dofs).moveToPtr(),
+        gsSumOp<T>::make(
+            makeMatrixOp(data.A00),
+            gsProductOp<T>::make(
+                makeMatrixOp(data.A01),
+                data.solver,
+                makeMatrixOp(data.A10)
+            )
+        )
+    );
+
+    data.dofs.swap(dofs);
+    m_localFactorizations.back() = give(data);
+}
+
+template <class T>
+void gsScaledDirichletPrec<T>::updateLocalMatrix( index_t k, const SparseMatrix& localMatrix )
+{
+    LocalFactorization & data = m_localFactorizations[k];
+    GISMO_ENSURE( data.solver, "gsScaledDirichletPrec::updateLocalMatrix: The factorization has not "
+        "been kept for this subdomain; use the variant of addSubdomain taking the local matrix." );
+
+    Blocks blocks = matrixBlocks(localMatrix, data.dofs);
+    blocks.A01 *= -1;
+
+    // The operators refer to these matrices, so they are updated in place
+    data.A00->swap(blocks.A00);
+    data.A01->swap(blocks.A01);
+    data.A10->swap(blocks.A10);
+    data.solver->factorize(blocks.A11);
+    if (data.dense)
+        denseSchurComplement(data, *data.dense);
+}
+
+template <class T>
+void gsScaledDirichletPrec<T>::denseSchurComplement( const LocalFactorization& data, Matrix& result )
+{
+    // The skeleton dofs are handled by solves with blocks of right-hand
+    // sides, so only a block of columns of A01 is stored as dense matrix
+    const index_t sz = data.A00->rows(), bs = 64;
+    Matrix rhs, tmp;
+    result = *data.A00;
+    for (index_t j=0; j<sz; j+=bs)
+    {
+        const index_t nc = math::min(bs, sz-j);
+        rhs = data.A01->middleCols(j, nc);
+        data.solver->apply(rhs, tmp);
+        result.middleCols(j, nc).noalias() += *data.A10 * tmp; // A01 is stored negated
+    }
+}
+
+template <class T>
+void gsScaledDirichletPrec<T>::setupDenseSchurComplements( index_t maxSkeletonDofs )
+{
+    const index_t pnr = m_localSchurOps.size();
+
+    std::vector< std::pair<index_t,index_t> > todo; // (-size, index)
+    for (index_t k=0; k<pnr; ++k)
+    {
+        const index_t sz = m_localSchurOps[k]->rows();
+        if (sz <= maxSkeletonDofs && !dynamic_cast<const gsMatrixOp<Matrix>*>(m_localSchurOps[k].get()))
+            todo.push_back(std::make_pair(-sz, k));
+    }
+    // The largest ones are started first
+    std::sort(todo.begin(), todo.end());
+
+    const index_t n = todo.size();
+#   pragma omp parallel for schedule(dynamic,1)
+    for (index_t i=0; i<n; ++i)
+    {
+        const index_t k = todo[i].second, sz = -todo[i].first;
+        LocalFactorization & data = m_localFactorizations[k];
+        memory::shared_ptr<Matrix> dense(new Matrix);
+        if (data.solver)
+        {
+            denseSchurComplement(data, *dense);
+            data.dense = dense;
+        }
+        else
+            m_localSchurOps[k]->apply(Matrix::Identity(sz, sz), *dense);
+        m_localSchurOps[k] = makeMatrixOp(dense);
+    }
+}
+
 template <class T>
 void gsScaledDirichletPrec<T>::setupMultiplicityScaling()
 {
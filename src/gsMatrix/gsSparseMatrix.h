@@ -271,6 +271,19 @@ public:
         Base::reserve(gsVector<index_t>::Constant(this->outerSize(), nz));
     }
 
+    /// Reserves memory such that every column (row, if RowMajor) has
+    /// room for \a nz non-zeros in total, counting the existing ones.
+    /// Eg. after a sum of matrices, which leaves the result
+    /// compressed, further insertions do not reallocate
+    void reserveUpToPerColumn(const index_t nz)
+    {
+        gsVector<index_t> room(this->outerSize());
+        for (index_t j = 0; j != room.size(); ++j)
+            room[j] = math::max(nz - static_cast<index_t>(this->innerVector(j).nonZeros()),
+                                (index_t)0);
+        Base::reserve(room);
+    }
+
     void setFrom( gsSparseEntries<T> const & entries) ;
 
     inline T   at (_Index i, _Index j ) const { return this->coeff(i,j); }
@@ -44,6 +44,10 @@ namespace gismo
 ///
 /// but much faster.
 ///
+/// If \ref setParallel is called, the operators \f$ A_i \f$ are applied
+/// concurrently (OpenMP), unless the same operator object occurs more
+/// than once.
+///
 /// @ingroup Solvers
 
 template<class T>
@@ -65,7 +69,7 @@ public:
     typedef memory::unique_ptr<gsAdditiveOp> uPtr;
 
     /// Default Constructor
-    gsAdditiveOp() : m_transfers(), m_ops() {}
+    gsAdditiveOp() : m_transfers(), m_ops(), m_parallel(false) {}
 
     /// @brief Constructor
     ///
@@ -74,7 +78,7 @@ public:
     /// @param transfers  transfer matrices \f$ T_i \f$
     /// @param ops        local operators \f$ A_i \f$
     gsAdditiveOp(TransferContainer transfers, OpContainer ops)
-    : m_transfers(), m_ops(give(ops))
+    : m_transfers(), m_ops(give(ops)), m_parallel(false)
     {
         const size_t sz = transfers.size();
         m_transfers.reserve(sz);
@@ -99,7 +103,7 @@ public:
     /// @param transfers  transfer matrices \f$ T_i \f$
     /// @param ops        local operators \f$ A_i \f$
     gsAdditiveOp(TransferPtrContainer transfers, OpContainer ops)
-    : m_transfers(give(transfers)), m_ops(give(ops))
+    : m_transfers(give(transfers)), m_ops(give(ops)), m_parallel(false)
     {
 #ifndef NDEBUG
         GISMO_ASSERT( m_transfers.size() == m_ops.size(), "Sizes do not agree" );
@@ -167,6 +171,13 @@ public:
                        "Dimensions of the operators do not fit." );
     }
 
+    /// @brief Sets whether the operators \f$ A_i \f$ are applied concurrently
+    ///
+    /// This requires that their apply functions can be called concurrently,
+    /// which is not the case for every \a gsLinearOperator. The result does
+    /// not depend on the number of threads. Default: false
+    void setParallel(bool parallel = true) { m_parallel = parallel; }
+
     void apply(const gsMatrix<T>& input, gsMatrix<T>& x) const;
 
     index_t rows() const
@@ -184,6 +195,7 @@ public:
 protected:
     TransferPtrContainer m_transfers;   ///< Transfer matrices
     OpContainer m_ops;                  ///< Operators to be applied in the subspaces
+    bool m_parallel;                    ///< Apply the operators concurrently
 
 };
 
@@ -19,17 +19,39 @@ void gsAdditiveOp<T>::apply(const gsMatrix<T>& input, gsMatrix<T>& x) const
 {
     GISMO_ASSERT( this->rows() == input.rows(), "The dimensions do not fit." );
 
-    x.setZero( input.rows(), input.cols() );
-
     const index_t n = m_ops.size();
-    gsMatrix<T> res_local, corr_local;
 
+    // If requested, the local problems are solved concurrently, the
+    // largest ones first. An operator might keep a state while it is
+    // applied, so this is only done if every operator occurs only once.
+    std::vector< std::pair<index_t,index_t> > order(n); // (-size, index)
     for (index_t i=0; i<n; ++i)
+        order[i] = std::make_pair(m_parallel ? -m_ops[i]->rows() : 0, i);
+    bool parallel = m_parallel && n > 1;
+    if (parallel)
+    {
+        std::sort(order.begin(), order.end());
+        std::vector<const gsLinearOperator<T>*> ops(n);
+        for (index_t i=0; i<n; ++i)
+            ops[i] = m_ops[i].get();
+        std::sort(ops.begin(), ops.end());
+        parallel = ( std::adjacent_find(ops.begin(), ops.end()) == ops.end() );
+    }
+
+    std::vector< gsMatrix<T> > corr_local(n);
+#   pragma omp parallel for schedule(dynamic,1) if (parallel)
+    for (index_t k=0; k<n; ++k)
     {
+        const index_t i = order[k].second;
+        gsMatrix<T> res_local;
         res_local.noalias() = m_transfers[i]->transpose()*input;
-        m_ops[i]->apply(res_local, corr_local);
-        x.noalias() += *(m_transfers[i])*corr_local;
+        m_ops[i]->apply(res_local, corr_local[i]);
     }
+
+    // Summation in the given order, which does not depend on the threads
+    x.setZero( input.rows(), input.cols() );
+    for (index_t i=0; i<n; ++i)
+        x.noalias() += *(m_transfers[i])*corr_local[i];
 }
 
 } // namespace gismo
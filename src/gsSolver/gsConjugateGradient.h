@@ -24,6 +24,15 @@ namespace gismo
 /// general preconditioners and better iteration control. Also capable of using
 /// a gsLinearOperator as matrix.
 ///
+/// Optionally, the pipelined variant by Ghysels and Vanroose is used (option
+/// "Pipelined"). It takes the same steps in exact arithmetic, but additionally
+/// updates the vectors \f$ A p \f$, \f$ M^{-1} r \f$, \f$ A M^{-1} r \f$
+/// and \f$ M^{-1} A p \f$ by recurrences. So, all vector updates and all inner
+/// products of one iteration are done in one sweep over the vectors, and only
+/// one reduction is required per iteration. The stopping criterion is based on
+/// the recursively updated residual, which might deviate from the true one
+/// due to round-off errors.
+///
 /// \ingroup Solver
 template<class T = real_t>
 class gsConjugateGradient : public gsIterativeSolver<T>
@@ -45,7 +54,7 @@ public:
     template< typename OperatorType >
     explicit gsConjugateGradient( const OperatorType& mat,
                                   const LinOpPtr& precond = LinOpPtr() )
-    : Base(mat, precond), m_calcEigenvals(false) {}
+    : Base(mat, precond), m_calcEigenvals(false), m_pipelined(false) {}
 
     /// @brief Make function using a matrix (operator) and optionally a preconditionner
     ///
@@ -61,6 +70,8 @@ public:
         gsOptionList opt = Base::defaultOptions();
         opt.addSwitch("CalcEigenvalues", "Additionally to solving the system,"
                       " CG computes the eigenvalues of the Lanczos matrix", false );
+        opt.addSwitch("Pipelined", "Use the pipelined variant, which requires one"
+                      " reduction and one sweep over the vectors per iteration", false );
         return opt;
     }
 
@@ -69,6 +80,7 @@ public:
     {
         Base::setOptions(opt);
         m_calcEigenvals = opt.askSwitch("CalcEigenvalues", m_calcEigenvals);
+        m_pipelined     = opt.askSwitch("Pipelined"      , m_pipelined    );
         return *this;
     }
 
@@ -79,6 +91,10 @@ public:
     /// @param flag true stores the coefficients of the lancos matrix, false not.
     void setCalcEigenvalues( bool flag )     { m_calcEigenvals = flag ;}
 
+    /// @brief specify if you want to use the pipelined variant
+    /// @param flag true uses the pipelined variant, false the standard one.
+    void setPipelined( bool flag )           { m_pipelined = flag; }
+
     /// @brief returns the condition number of the (preconditioned) system matrix
     T getConditionNumber();
 
@@ -93,6 +109,13 @@ public:
     }
 
 private:
+    bool initIterationPipelined( const VectorType& rhs, VectorType& x );
+    bool stepPipelined( VectorType& x );
+
+    /// Updates the vectors of the pipelined variant and computes the inner
+    /// products (r,r), (r,u) and (w,u) of the new vectors in one sweep
+    void fusedUpdate( VectorType& x, T& rr, T& ru, T& wu );
+
     using Base::m_mat;
     using Base::m_precond;
     using Base::m_max_iters;
@@ -108,6 +131,17 @@ private:
     T m_abs_new;
 
     bool m_calcEigenvals;
+    bool m_pipelined;
+
+    // Additional data for the pipelined variant; m_res is the residual r,
+    // m_update the search direction p and m_tmp stores M^{-1} w
+    VectorType m_u;      // M^{-1} r
+    VectorType m_w;      // A M^{-1} r
+    VectorType m_s;      // A p
+    VectorType m_q;      // M^{-1} A p
+    VectorType m_z;      // A M^{-1} A p
+    VectorType m_n;      // A M^{-1} w
+    T m_alpha, m_beta;   // the step sizes to be used in the next step
 
     std::vector<T> m_delta, m_gamma;
 };
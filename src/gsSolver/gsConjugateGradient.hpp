@@ -33,6 +33,9 @@ bool gsConjugateGradient<T>::initIteration( const typename gsConjugateGradient<T
     if (Base::initIteration(rhs,x))
         return true;
 
+    if (m_pipelined)
+        return initIterationPipelined(rhs,x);
+
     index_t n = m_mat->cols();
     index_t m = 1;                                                      // == rhs.cols();
     m_tmp.resize(n,m);
@@ -54,6 +57,9 @@ bool gsConjugateGradient<T>::initIteration( const typename gsConjugateGradient<T
 template<class T>
 bool gsConjugateGradient<T>::step( typename gsConjugateGradient<T>::VectorType& x )
 {
+    if (m_pipelined)
+        return stepPipelined(x);
+
     m_mat->apply(m_update,m_tmp);                                      // apply system matrix
 
     T alpha = m_abs_new / m_update.col(0).dot(m_tmp.col(0));           // the amount we travel on dir
@@ -83,6 +89,99 @@ bool gsConjugateGradient<T>::step( typename gsConjugateGradient<T>::VectorType&
     return false;
 }
 
+template<class T>
+bool gsConjugateGradient<T>::initIterationPipelined( const typename gsConjugateGradient<T>::VectorType& rhs,
+                                                     typename gsConjugateGradient<T>::VectorType& x )
+{
+    index_t n = m_mat->cols();
+
+    m_mat->apply(x,m_tmp);                                              // apply the system matrix
+    m_res = rhs - m_tmp;                                                // initial residual
+
+    m_error = m_res.norm() / m_rhs_norm;
+    if (m_error < m_tol)
+        return true;
+
+    m_precond->apply(m_res,m_u);                                        // u = M^{-1} r
+    m_mat->apply(m_u,m_w);                                              // w = A u
+    m_abs_new = m_res.col(0).dot(m_u.col(0));
+    m_alpha = m_abs_new / m_w.col(0).dot(m_u.col(0));
+    m_beta = 0;
+
+    // The search direction and the vectors derived from it start with zero,
+    // so the first step sets them up
+    m_update.setZero(n,1);
+    m_s.setZero(n,1);
+    m_q.setZero(n,1);
+    m_z.setZero(n,1);
+
+    return false;
+}
+
+template<class T>
+bool gsConjugateGradient<T>::stepPipelined( typename gsConjugateGradient<T>::VectorType& x )
+{
+    m_precond->apply(m_w,m_tmp);                                       // m = M^{-1} w
+    m_mat->apply(m_tmp,m_n);                                           // n = A m
+
+    if (m_calcEigenvals)
+        m_delta.back()+=(1./m_alpha);
+
+    const T abs_old = m_abs_new;
+    T abs_res, wu;
+    fusedUpdate(x, abs_res, m_abs_new, wu);                            // update all vectors and compute the inner products
+
+    m_error = math::sqrt(abs_res) / m_rhs_norm;
+    if (m_error < m_tol)
+        return true;
+
+    // The step sizes for the next step are already known, since the inner
+    // products replace (p,Ap) by a recurrence
+    const T alpha_old = m_alpha;
+    m_beta = m_abs_new / abs_old;
+    m_alpha = m_abs_new / (wu - m_beta * m_abs_new / alpha_old);
+
+    if (m_calcEigenvals)
+    {
+        m_gamma.push_back(-math::sqrt(m_beta)/alpha_old);
+        m_delta.push_back(m_beta/alpha_old);
+    }
+    return false;
+}
+
+template<class T>
+void gsConjugateGradient<T>::fusedUpdate( typename gsConjugateGradient<T>::VectorType& x, T& rr, T& ru, T& wu )
+{
+    const index_t sz = x.rows();
+    const T alpha = m_alpha, beta = m_beta;
+    T * xx = x.data();
+    T * r  = m_res.data();
+    T * p  = m_update.data();
+    T * u  = m_u.data();
+    T * w  = m_w.data();
+    T * s  = m_s.data();
+    T * q  = m_q.data();
+    T * z  = m_z.data();
+    const T * m = m_tmp.data();
+    const T * n = m_n.data();
+
+    rr = ru = wu = 0;
+    for (index_t i=0; i<sz; ++i)
+    {
+        z[i]   = n[i] + beta * z[i];
+        q[i]   = m[i] + beta * q[i];
+        s[i]   = w[i] + beta * s[i];
+        p[i]   = u[i] + beta * p[i];
+        xx[i] += alpha * p[i];
+        r[i]  -= alpha * s[i];
+        u[i]  -= alpha * q[i];
+        w[i]  -= alpha * z[i];
+        rr    += r[i] * r[i];
+        ru    += r[i] * u[i];
+        wu    += w[i] * u[i];
+    }
+}
+
 template<class T>
 T gsConjugateGradient<T>::getConditionNumber()
 {
@@ -102,8 +201,14 @@ T gsConjugateGradient<T>::getConditionNumber()
     else
     {
         T tmp_original = m_delta.back();
-        m_mat->apply(m_update,m_tmp);
-        T alpha = m_abs_new / m_update.col(0).dot(m_tmp.col(0));
+        T alpha;
+        if (m_pipelined)
+            alpha = m_alpha;                                           // already known
+        else
+        {
+            m_mat->apply(m_update,m_tmp);
+            alpha = m_abs_new / m_update.col(0).dot(m_tmp.col(0));
+        }
         m_delta.back()+=(1./alpha);
         gsLanczosMatrix<T> L(m_gamma,m_delta);
         T result = L.maxEigenvalue()/L.minEigenvalue();
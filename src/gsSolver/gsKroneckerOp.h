@@ -13,6 +13,11 @@
 #pragma once
 
 #include <gsSolver/gsLinearOperator.h>
+#include <gsSolver/gsMatrixOp.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace gismo
 {
@@ -78,6 +83,12 @@ public:
     /// Return a vector of shared pointers to all operators
     const std::vector<BasePtr>& getOps() const { return m_ops; }
 
+    /// \brief Returns true if all operators are gsMatrixOp of a dense
+    /// or sparse matrix (or of its transpose). Then apply() multiplies
+    /// the slices of the input by the matrices directly, without
+    /// re-ordering the input.
+    bool matrixFactors() const;
+
     /// Apply provided linear operators without the need of creating an object
     static void apply(const std::vector<BasePtr> & ops, const gsMatrix<T> & input, gsMatrix<T> & x);
 
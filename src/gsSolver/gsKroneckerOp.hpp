@@ -15,6 +15,129 @@ namespace gismo
 {
 
 /// @cond
+namespace internal
+{
+
+// Mode product of the tensor X of size L x m x R (column-major, stored at
+// src) with the matrix A of size p x m, i.e. Y_r = X_r A^T for all slices
+// r, giving Y of size L x p x R (stored at dst).
+template <class MatrixType, typename T>
+void kroneckerModeProduct(const MatrixType & A, const T * src, T * dst,
+                          const index_t L, const index_t R)
+{
+    typedef typename gsMatrix<T>::Base                         DenseMatrix;
+    typedef Eigen::Map<const DenseMatrix,0,Eigen::OuterStride<> > ConstStridedMap;
+    typedef Eigen::Map<DenseMatrix,0,Eigen::OuterStride<> >       StridedMap;
+
+    const index_t m = A.cols(), p = A.rows();
+#   ifdef _OPENMP
+    const index_t nt = omp_get_max_threads();
+#   else
+    const index_t nt = 1;
+#   endif
+
+    if (1 == L)
+    {
+        // Y = A X, split into one block of columns per thread. Smaller
+        // blocks would only repeat the packing of A inside the product.
+        const index_t bs = math::max<index_t>(64, (R + nt - 1) / nt);
+        const index_t nb = (R + bs - 1) / bs;
+#       pragma omp parallel for schedule(static) if (nb > 1)
+        for (index_t b = 0; b < nb; ++b)
+        {
+            const index_t c0 = b * bs, nc = math::min(bs, R - c0);
+            gsAsMatrix<T>(dst + c0 * p, p, nc).noalias()
+                = A * gsAsConstMatrix<T>(src + c0 * m, m, nc);
+        }
+    }
+    else
+    {
+        // Y_r = X_r A^T for every slice; the slices are split into
+        // blocks of rows only if there are fewer slices than threads
+        const index_t perSlice = math::max<index_t>(1, nt / R);
+        const index_t bs = math::max<index_t>(64, (L + perSlice - 1) / perSlice);
+        const index_t nb = (L + bs - 1) / bs, nItems = R * nb;
+#       pragma omp parallel for schedule(static) if (nItems > 1)
+        for (index_t k = 0; k < nItems; ++k)
+        {
+            const index_t r = k / nb, l0 = (k % nb) * bs, nl = math::min(bs, L - l0);
+            StridedMap( dst + r * L * p + l0, nl, p, Eigen::OuterStride<>(L) ).noalias()
+                = ConstStridedMap( src + r * L * m + l0, nl, m, Eigen::OuterStride<>(L) ) * A.transpose();
+        }
+    }
+}
+
+// Gives access to the matrix of a factor, if it is a gsMatrixOp of a
+// dense or a sparse matrix, or of its transpose
+template <typename T>
+struct kroneckerMatrixFactor
+{
+    typedef typename gsMatrix<T>::Base       DenseMatrix;
+    typedef typename gsSparseMatrix<T>::Base SparseMatrix;
+
+    explicit kroneckerMatrixFactor(const gsLinearOperator<T> & op)
+    : dense(NULL), denseT(NULL), sparse(NULL), sparseT(NULL)
+    {
+        if ( !get<gsMatrix<T> >(op, dense) && !get<DenseMatrix>(op, dense) )
+            getTranspose<DenseMatrix>(op, denseT);
+        if ( !isMatrix() && !get<gsSparseMatrix<T> >(op, sparse) && !get<SparseMatrix>(op, sparse) )
+            getTranspose<SparseMatrix>(op, sparseT);
+    }
+
+    bool isMatrix() const { return dense || denseT || sparse || sparseT; }
+
+    void modeProduct(const T * src, T * dst, const index_t L, const index_t R) const
+    {
+        if (dense)
+            kroneckerModeProduct(*dense, src, dst, L, R);
+        else if (denseT)
+            kroneckerModeProduct(denseT->transpose(), src, dst, L, R);
+        else if (sparse)
+            kroneckerModeProduct(*sparse, src, dst, L, R);
+        else
+            kroneckerModeProduct(sparseT->transpose(), src, dst, L, R);
+    }
+
+    const DenseMatrix  * dense;   ///< The matrix A
+    const DenseMatrix  * denseT;  ///< The matrix A^T
+    const SparseMatrix * sparse;  ///< The matrix A
+    const SparseMatrix * sparseT; ///< The matrix A^T
+
+private:
+
+    template <class MatrixType, class Base>
+    static bool get(const gsLinearOperator<T> & op, const Base * & mat)
+    {
+        if ( const gsMatrixOp<MatrixType> * o = dynamic_cast<const gsMatrixOp<MatrixType>*>(&op) )
+            mat = &o->matrix();
+        return NULL != mat;
+    }
+
+    // The transpose of a const or of a non-const matrix
+    template <class Base>
+    static bool getTranspose(const gsLinearOperator<T> & op, const Base * & mat)
+    {
+        if ( const gsMatrixOp<Eigen::Transpose<const Base> > * o
+             = dynamic_cast<const gsMatrixOp<Eigen::Transpose<const Base> >*>(&op) )
+            mat = &o->matrix().nestedExpression();
+        else if ( const gsMatrixOp<Eigen::Transpose<Base> > * o
+                  = dynamic_cast<const gsMatrixOp<Eigen::Transpose<Base> >*>(&op) )
+            mat = &o->matrix().nestedExpression();
+        return NULL != mat;
+    }
+};
+
+} // namespace internal
+
+template <typename T>
+bool gsKroneckerOp<T>::matrixFactors() const
+{
+    for (size_t i = 0; i < m_ops.size(); ++i)
+        if ( !internal::kroneckerMatrixFactor<T>(*m_ops[i]).isMatrix() )
+            return false;
+    return true;
+}
+
 template <typename T>
 void gsKroneckerOp<T>::apply(const std::vector<typename gsLinearOperator<T>::Ptr> & ops, const gsMatrix<T> & input, gsMatrix<T> & x)
 {
@@ -30,15 +153,45 @@ void gsKroneckerOp<T>::apply(const std::vector<typename gsLinearOperator<T>::Ptr
     //index_t rows = 1; // we don't compute rows as we do not need it
     index_t sz = 1;
 
+    bool allMatrices = true;
     for (index_t i = 0; i < nrOps; ++i)
     {
         //rows *= ops[i]->rows();
         sz *= ops[i]->cols();
+        allMatrices = allMatrices && internal::kroneckerMatrixFactor<T>(*ops[i]).isMatrix();
     }
 
     GISMO_ASSERT (sz == input.rows(), "The input matrix has wrong size.");
     const index_t n = input.cols();
 
+    if (allMatrices)
+    {
+        // The input is a tensor of size cols_0 x ... x cols_{nrOps-1} x n,
+        // where the index of the last operator runs fastest. The
+        // operators are applied mode by mode (from the last to the first
+        // one), using matrix-matrix products on the slices of the tensor
+        // without transposing it. The result of the last mode product is
+        // written to x, the others alternate between x and temp.
+        gsMatrix<T> temp, in;
+        if (&input == &x) in = input; // x is overwritten by the first product
+        const T * src = (&input == &x ? in.data() : input.data());
+        index_t L = 1, R = sz * n;
+        for (index_t i = nrOps - 1; i >= 0; --i)
+        {
+            const index_t cols_i = ops[i]->cols();
+            const index_t rows_i = ops[i]->rows();
+            R /= cols_i;
+
+            gsMatrix<T> & dst = ( i % 2 == 0 ? x : temp );
+            dst.resize(L * rows_i * R / n, n);
+            internal::kroneckerMatrixFactor<T>(*ops[i]).modeProduct(src, dst.data(), L, R);
+
+            src = dst.data();
+            L *= rows_i;
+        }
+        return;
+    }
+
     // Note: algorithm relies on col-major matrices
     gsMatrix<T, Dynamic, Dynamic, ColMajor> q0, q1;
     gsMatrix<T> temp;
@@ -208,6 +208,17 @@ public:
         x = m_solver.solve(input);
     }
 
+    /// @brief Recomputes the numerical factorization for a matrix that has
+    /// the same sparsity pattern as the matrix given before
+    ///
+    /// The symbolic analysis (ordering and elimination tree) is reused. This
+    /// is only available for the sparse direct solvers.
+    void factorize(const MatrixType& mat)
+    {
+        GISMO_ASSERT(mat.rows() == m_size && mat.cols() == m_size, "The size of the matrix has changed");
+        m_solver.factorize(mat);
+    }
+
     index_t rows() const { return m_size; }
 
     index_t cols() const { return m_size; }
@@ -14,6 +14,7 @@
 
 #include <gsCore/gsLinearAlgebra.h>
 #include <gsSolver/gsPreconditioner.h>
+#include <gsSolver/gsConjugateGradient.h>
 
 namespace gismo
 {
@@ -24,6 +25,11 @@ template<typename T>
 void gaussSeidelSweep(const gsSparseMatrix<T> & A, gsMatrix<T>& x, const gsMatrix<T>& f);
 template<typename T>
 void reverseGaussSeidelSweep(const gsSparseMatrix<T> & A, gsMatrix<T>& x, const gsMatrix<T>& f);
+template<typename T>
+void matrixGraphColoring(const typename gsSparseMatrix<T>::Base & A, std::vector< std::vector<index_t> > & colors);
+template<typename T>
+void multiColorGaussSeidelSweep(const typename gsSparseMatrix<T>::Base & A, const std::vector< std::vector<index_t> > & colors,
+                                const bool reverse, gsMatrix<T>& x, const gsMatrix<T>& f);
 } // namespace internal
 
 /// @brief Richardson preconditioner
@@ -388,6 +394,323 @@ template <class Derived>
 typename gsGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::uPtr makeSymmetricGaussSeidelOp(const memory::shared_ptr<Derived>& mat)
 { return gsGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::make(mat); }
 
+/// @brief Multicolor Gauss-Seidel preconditioner
+///
+/// The rows of the matrix are colored such that no two rows of the same
+/// color are coupled (greedy coloring of the matrix graph). A sweep
+/// processes the colors one after the other and updates the rows of
+/// one color in parallel (OpenMP). For a symmetric matrix, this is a
+/// Gauss-Seidel method for a permutation of the unknowns; so the
+/// smoothing properties are those of the standard Gauss-Seidel method.
+///
+/// `ordering` can be `gsGaussSeidel::forward`, `gsGaussSeidel::reverse` or `gsGaussSeidel::symmetric`.
+/// The colors are computed in the constructor; the sparsity pattern of the
+/// matrix must not change afterwards.
+///
+/// \ingroup Solver
+template <typename MatrixType, gsGaussSeidel::ordering ordering = gsGaussSeidel::forward>
+class gsMultiColorGaussSeidelOp GISMO_FINAL : public gsPreconditionerOp<typename MatrixType::Scalar>
+{
+    typedef memory::shared_ptr<MatrixType>          MatrixPtr;
+    typedef typename MatrixType::Nested             NestedMatrix;
+
+public:
+    /// Scalar type
+    typedef typename MatrixType::Scalar T;
+
+    /// Shared pointer for gsMultiColorGaussSeidelOp
+    typedef memory::shared_ptr< gsMultiColorGaussSeidelOp > Ptr;
+
+    /// Unique pointer for gsMultiColorGaussSeidelOp
+    typedef memory::unique_ptr< gsMultiColorGaussSeidelOp > uPtr;
+
+    /// Base class
+    typedef gsPreconditionerOp<T> Base;
+
+    /// Constructor with given matrix
+    explicit gsMultiColorGaussSeidelOp(const MatrixType& mat)
+    : m_mat(), m_expr(mat.derived())
+    { internal::matrixGraphColoring<T>(m_expr, m_colors); }
+
+    /// Constructor with shared pointer to matrix
+    explicit gsMultiColorGaussSeidelOp(const MatrixPtr& mat)
+    : m_mat(mat), m_expr(m_mat->derived())
+    { internal::matrixGraphColoring<T>(m_expr, m_colors); }
+
+    static uPtr make(const MatrixType& mat)
+    { return memory::make_unique( new gsMultiColorGaussSeidelOp(mat) ); }
+
+    static uPtr make(const MatrixPtr& mat)
+    { return memory::make_unique( new gsMultiColorGaussSeidelOp(mat) ); }
+
+    void step(const gsMatrix<T> & rhs, gsMatrix<T> & x) const
+    {
+        if ( ordering == gsGaussSeidel::forward )
+            internal::multiColorGaussSeidelSweep<T>(m_expr,m_colors,false,x,rhs);
+        if ( ordering == gsGaussSeidel::reverse )
+            internal::multiColorGaussSeidelSweep<T>(m_expr,m_colors,true,x,rhs);
+        if ( ordering == gsGaussSeidel::symmetric )
+        {
+            internal::multiColorGaussSeidelSweep<T>(m_expr,m_colors,false,x,rhs);
+            internal::multiColorGaussSeidelSweep<T>(m_expr,m_colors,true,x,rhs);
+        }
+    }
+
+    void stepT(const gsMatrix<T> & rhs, gsMatrix<T> & x) const
+    {
+        if ( ordering == gsGaussSeidel::forward )
+            internal::multiColorGaussSeidelSweep<T>(m_expr,m_colors,true,x,rhs);
+        if ( ordering == gsGaussSeidel::reverse )
+            internal::multiColorGaussSeidelSweep<T>(m_expr,m_colors,false,x,rhs);
+        if ( ordering == gsGaussSeidel::symmetric )
+        {
+            internal::multiColorGaussSeidelSweep<T>(m_expr,m_colors,false,x,rhs);
+            internal::multiColorGaussSeidelSweep<T>(m_expr,m_colors,true,x,rhs);
+        }
+    }
+
+    index_t rows() const {return m_expr.rows();}
+    index_t cols() const {return m_expr.cols();}
+
+    /// Returns the matrix
+    NestedMatrix matrix() const { return m_expr; }
+
+    /// Returns a shared pinter to the matrix
+    MatrixPtr    matrixPtr() const {
+        GISMO_ENSURE( m_mat, "A shared pointer is only available if it was provided to gsMultiColorGaussSeidelOp." );
+        return m_mat;
+    }
+
+    typename gsLinearOperator<T>::Ptr underlyingOp() const { return makeMatrixOp(m_mat); }
+
+    /// Returns the number of colors
+    index_t numColors() const { return static_cast<index_t>(m_colors.size()); }
+
+    /// Returns the (ascending) indices of the rows of color \a c
+    const std::vector<index_t> & color(index_t c) const { return m_colors[c]; }
+
+private:
+    const MatrixPtr m_mat;  ///< Shared pointer to matrix (if needed)
+    NestedMatrix    m_expr; ///< Nested Eigen expression
+    std::vector< std::vector<index_t> > m_colors; ///< Row indices, grouped by color
+};
+
+/// @brief Returns a smart pointer to a multicolor Gauss-Seidel operator referring on \a mat
+/// \relates gsMultiColorGaussSeidelOp
+template <class Derived>
+typename gsMultiColorGaussSeidelOp<Derived>::uPtr makeMultiColorGaussSeidelOp(const Eigen::EigenBase<Derived>& mat)
+{ return gsMultiColorGaussSeidelOp<Derived>::make(mat.derived()); }
+
+/// @brief Returns a smart pointer to a multicolor Gauss-Seidel operator referring on \a mat
+/// \relates gsMultiColorGaussSeidelOp
+template <class Derived>
+typename gsMultiColorGaussSeidelOp<Derived>::uPtr makeMultiColorGaussSeidelOp(const memory::shared_ptr<Derived>& mat)
+{ return gsMultiColorGaussSeidelOp<Derived>::make(mat); }
+
+/// @brief Returns a smart pointer to a symmetric multicolor Gauss-Seidel operator referring on \a mat
+/// \relates gsMultiColorGaussSeidelOp
+template <class Derived>
+typename gsMultiColorGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::uPtr makeSymmetricMultiColorGaussSeidelOp(const Eigen::EigenBase<Derived>& mat)
+{ return gsMultiColorGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::make(mat.derived()); }
+
+/// @brief Returns a smart pointer to a symmetric multicolor Gauss-Seidel operator referring on \a mat
+/// \relates gsMultiColorGaussSeidelOp
+template <class Derived>
+typename gsMultiColorGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::uPtr makeSymmetricMultiColorGaussSeidelOp(const memory::shared_ptr<Derived>& mat)
+{ return gsMultiColorGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::make(mat); }
+
+/// @brief Chebyshev smoother
+///
+/// One step applies the Chebyshev polynomial iteration of the given
+/// degree to the Jacobi preconditioned system \f$ D^{-1} A \f$, which
+/// damps the eigencomponents in the interval
+/// \f$ [\ell \lambda_{\max}, u \lambda_{\max}] \f$,
+/// where \f$ \lambda_{\max} \f$ is an estimate for the largest
+/// eigenvalue of \f$ D^{-1} A \f$. By default, \f$ \ell = 0.1 \f$
+/// and \f$ u = 1.1 \f$, which covers the high frequencies.
+///
+/// \f$ \lambda_{\max} \f$ is estimated in the constructor, using the
+/// eigenvalues of the Lanczos matrix (see \a gsLanczosMatrix) obtained from
+/// a few steps of the Jacobi preconditioned conjugate gradient method.
+///
+/// A step only consists of sparse matrix-vector products and vector
+/// updates, which are parallelized with OpenMP. The matrix is supposed
+/// to be symmetric and positive definite; so it doesn't matter if it is
+/// stored in row- or column-major order.
+///
+/// \ingroup Solver
+template <typename MatrixType>
+class gsChebyshevSmootherOp GISMO_FINAL : public gsPreconditionerOp<typename MatrixType::Scalar>
+{
+    typedef memory::shared_ptr<MatrixType>          MatrixPtr;
+    typedef typename MatrixType::Nested             NestedMatrix;
+
+public:
+    /// Scalar type
+    typedef typename MatrixType::Scalar T;
+
+    /// Shared pointer for gsChebyshevSmootherOp
+    typedef memory::shared_ptr< gsChebyshevSmootherOp > Ptr;
+
+    /// Unique pointer for gsChebyshevSmootherOp
+    typedef memory::unique_ptr< gsChebyshevSmootherOp > uPtr;
+
+    /// Base class
+    typedef gsPreconditionerOp<T> Base;
+
+    /// Constructor with given matrix
+    explicit gsChebyshevSmootherOp(const MatrixType& mat, index_t degree = 2)
+    : m_mat(), m_expr(mat.derived()), m_degree(degree), m_lower(0.1), m_upper(1.1)
+    { init(); }
+
+    /// Constructor with shared pointer to matrix
+    explicit gsChebyshevSmootherOp(const MatrixPtr& mat, index_t degree = 2)
+    : m_mat(mat), m_expr(m_mat->derived()), m_degree(degree), m_lower(0.1), m_upper(1.1)
+    { init(); }
+
+    static uPtr make(const MatrixType& mat, index_t degree = 2)
+    { return memory::make_unique( new gsChebyshevSmootherOp(mat, degree) ); }
+
+    static uPtr make(const MatrixPtr& mat, index_t degree = 2)
+    { return memory::make_unique( new gsChebyshevSmootherOp(mat, degree) ); }
+
+    void step(const gsMatrix<T> & rhs, gsMatrix<T> & x) const
+    {
+        GISMO_ASSERT( m_expr.rows() == x.rows() && x.rows() == rhs.rows() && x.cols() == rhs.cols(),
+            "Dimensions do not match.");
+
+        GISMO_ASSERT( rhs.cols() == 1, "This operator is only implemented for a single right-hand side." );
+
+        const index_t n = m_expr.outerSize();
+        const T a = m_lower * m_maxEig, b = m_upper * m_maxEig;
+        const T theta = (b + a) / 2, delta = (b - a) / 2, sigma = theta / delta;
+        m_res.resize(n,1);
+        m_dir.resize(n,1);
+
+#       pragma omp parallel
+        {
+            T rho = 1 / sigma;
+            for (index_t k = 0; k < m_degree; ++k)
+            {
+                // r = D^{-1} ( f - A x )
+#               pragma omp for schedule(static)
+                for (index_t i = 0; i < n; ++i)
+                {
+                    T sum = 0;
+                    for (typename MatrixType::InnerIterator it(m_expr,i); it; ++it)
+                        sum += it.value() * x( it.index() );
+                    m_res(i) = m_invDiag(i) * ( rhs(i) - sum );
+                }
+
+                // three-term recurrence for the update d, then x += d
+                const T rhoNew = ( 0 == k ? rho : 1 / (2 * sigma - rho) );
+#               pragma omp for schedule(static)
+                for (index_t i = 0; i < n; ++i)
+                {
+                    m_dir(i) = ( 0 == k ? m_res(i) / theta
+                                        : rhoNew * rho * m_dir(i) + 2 * rhoNew / delta * m_res(i) );
+                    x(i) += m_dir(i);
+                }
+                rho = rhoNew;
+            }
+        }
+    }
+
+    index_t rows() const {return m_expr.rows();}
+    index_t cols() const {return m_expr.cols();}
+
+    /// Estimates the largest eigenvalue of \f$ D^{-1} A \f$ using \a steps
+    /// steps of the Jacobi preconditioned conjugate gradient method
+    void estimateMaxEigenvalue(index_t steps = 10)
+    {
+        gsConjugateGradient<T> cg(m_expr, makeJacobiOp(m_expr));
+        cg.setCalcEigenvalues(true);
+        cg.setMaxIterations(steps);
+        gsMatrix<T> rhs, x;
+        rhs.setRandom(m_expr.rows(),1);
+        x.setZero(m_expr.rows(),1);
+        cg.solve(rhs,x);
+        gsMatrix<T> eigs;
+        cg.getEigenvalues(eigs);
+        m_maxEig = eigs.size() ? eigs.maxCoeff() : (T)1;
+    }
+
+    /// Sets the largest eigenvalue of \f$ D^{-1} A \f$, if it is known a priori
+    void setMaxEigenvalue(const T lmax) { m_maxEig = lmax; }
+
+    /// Returns the (estimated) largest eigenvalue of \f$ D^{-1} A \f$
+    T maxEigenvalue() const { return m_maxEig; }
+
+    /// Sets the polynomial degree, i.e., the number of matrix-vector products per step
+    void setDegree(const index_t degree) { m_degree = degree; }
+
+    /// Sets the interval \f$ [\ell \lambda_{\max}, u \lambda_{\max}] \f$ to be damped
+    void setEigenvalueInterval(const T lower, const T upper)
+    {
+        GISMO_ASSERT( 0 < lower && lower < upper, "Invalid interval." );
+        m_lower = lower;
+        m_upper = upper;
+    }
+
+    /// Get the default options as gsOptionList object
+    static gsOptionList defaultOptions()
+    {
+        gsOptionList opt = Base::defaultOptions();
+        opt.addInt ( "Degree", "Degree of the Chebyshev polynomial", 2 );
+        opt.addReal( "LowerBound", "Lower end of the damped interval, relative to the largest eigenvalue", 0.1 );
+        opt.addReal( "UpperBound", "Upper end of the damped interval, relative to the largest eigenvalue", 1.1 );
+        return opt;
+    }
+
+    /// Set options based on a gsOptionList object
+    virtual void setOptions(const gsOptionList & opt)
+    {
+        Base::setOptions(opt);
+        m_degree = opt.askInt ( "Degree", m_degree );
+        setEigenvalueInterval( opt.askReal( "LowerBound", m_lower ), opt.askReal( "UpperBound", m_upper ) );
+    }
+
+    /// Returns the matrix
+    NestedMatrix matrix() const { return m_expr; }
+
+    /// Returns a shared pinter to the matrix
+    MatrixPtr    matrixPtr() const {
+        GISMO_ENSURE( m_mat, "A shared pointer is only available if it was provided to gsChebyshevSmootherOp." );
+        return m_mat;
+    }
+
+    typename gsLinearOperator<T>::Ptr underlyingOp() const { return makeMatrixOp(m_mat); }
+
+private:
+
+    void init()
+    {
+        GISMO_ASSERT( m_expr.rows() == m_expr.cols(), "The matrix is not square." );
+        m_invDiag = m_expr.diagonal().cwiseInverse();
+        estimateMaxEigenvalue();
+    }
+
+private:
+    const MatrixPtr m_mat;  ///< Shared pointer to matrix (if needed)
+    NestedMatrix    m_expr; ///< Nested Eigen expression
+    gsVector<T>     m_invDiag;
+    index_t         m_degree;
+    T               m_maxEig, m_lower, m_upper;
+    mutable gsMatrix<T> m_res, m_dir;
+};
+
+/// @brief Returns a smart pointer to a Chebyshev smoother referring on \a mat
+/// \relates gsChebyshevSmootherOp
+template <class Derived>
+typename gsChebyshevSmootherOp<Derived>::uPtr makeChebyshevSmootherOp(const Eigen::EigenBase<Derived>& mat, index_t degree = 2)
+{ return gsChebyshevSmootherOp<Derived>::make(mat.derived(), degree); }
+
+/// @brief Returns a smart pointer to a Chebyshev smoother referring on \a mat
+/// \relates gsChebyshevSmootherOp
+template <class Derived>
+typename gsChebyshevSmootherOp<Derived>::uPtr makeChebyshevSmootherOp(const memory::shared_ptr<Derived>& mat, index_t degree = 2)
+{ return gsChebyshevSmootherOp<Derived>::make(mat, degree); }
+
 /// @brief  Incomplete LU with thresholding preconditioner
 ///
 /// \ingroup Solvers
@@ -67,6 +67,82 @@ void reverseGaussSeidelSweep(const gsSparseMatrix<T> & A, gsMatrix<T>& x, const
     }
 }
 
+template<typename T>
+void matrixGraphColoring(const typename gsSparseMatrix<T>::Base & A, std::vector< std::vector<index_t> > & colors)
+{
+    GISMO_ASSERT( A.cols() == A.rows(), "The matrix is not square.");
+
+    // Greedy coloring: every row gets the smallest color that is not
+    // used by one of its neighbors in the graph of A. A is supposed to
+    // be symmetric, so the neighbors are the indices of the outer vector i.
+    const index_t n = A.outerSize();
+    std::vector<index_t> color(n, -1);
+    std::vector<index_t> mark; // mark[c] == i if color c is taken by a neighbor of i
+    index_t nColors = 0;
+    for (index_t i = 0; i < n; ++i)
+    {
+        for (typename gsSparseMatrix<T>::Base::InnerIterator it(A,i); it; ++it)
+        {
+            const index_t c = color[it.index()];
+            if (-1 != c) mark[c] = i;
+        }
+        index_t c = 0;
+        while (c < nColors && mark[c] == i) ++c;
+        if (c == nColors)
+        {
+            ++nColors;
+            mark.push_back(-1);
+        }
+        color[i] = c;
+    }
+
+    colors.clear();
+    colors.resize(nColors);
+    for (index_t i = 0; i < n; ++i)
+        colors[color[i]].push_back(i);
+}
+
+template<typename T>
+void multiColorGaussSeidelSweep(const typename gsSparseMatrix<T>::Base & A, const std::vector< std::vector<index_t> > & colors,
+                                const bool reverse, gsMatrix<T>& x, const gsMatrix<T>& f)
+{
+    GISMO_ASSERT( A.rows() == x.rows() && x.rows() == f.rows() && A.cols() == A.rows() && x.cols() == f.cols(),
+        "Dimensions do not match.");
+
+    GISMO_ASSERT( f.cols() == 1, "This operator is only implemented for a single right-hand side." );
+
+    const index_t nColors = static_cast<index_t>(colors.size());
+
+    // The rows of one color are not coupled, so they can be updated
+    // concurrently. The colors themselves are processed one after the other.
+#   pragma omp parallel
+    {
+        for (index_t k = 0; k < nColors; ++k)
+        {
+            const std::vector<index_t> & rows = colors[reverse ? nColors-1-k : k];
+            const index_t nRows = static_cast<index_t>(rows.size());
+#           pragma omp for schedule(static)
+            for (index_t r = 0; r < nRows; ++r)
+            {
+                const index_t i = reverse ? rows[nRows-1-r] : rows[r];
+                T diag = 0;
+                T sum  = 0;
+
+                // A is supposed to be symmetric, so it doesn't matter if it's stored in row- or column-major order
+                for (typename gsSparseMatrix<T>::Base::InnerIterator it(A,i); it; ++it)
+                {
+                    sum += it.value() * x( it.index() );        // compute A.x
+                    if (it.index() == i)
+                        diag = it.value();
+                }
+
+                x(i) += (f(i) - sum) / diag;
+            }
+            // implicit barrier: the next color uses the updated values
+        }
+    }
+}
+
 } // namespace internal
 
 } // namespace gismo
@@ -9,6 +9,9 @@ namespace internal
 
 TEMPLATE_INST void gaussSeidelSweep(const gsSparseMatrix<real_t> & A, gsMatrix<real_t>& x, const gsMatrix<real_t>& f);
 TEMPLATE_INST void reverseGaussSeidelSweep(const gsSparseMatrix<real_t> & A, gsMatrix<real_t>& x, const gsMatrix<real_t>& f);
+TEMPLATE_INST void matrixGraphColoring<real_t>(const gsSparseMatrix<real_t>::Base & A, std::vector< std::vector<index_t> > & colors);
+TEMPLATE_INST void multiColorGaussSeidelSweep<real_t>(const gsSparseMatrix<real_t>::Base & A, const std::vector< std::vector<index_t> > & colors,
+                                                      const bool reverse, gsMatrix<real_t>& x, const gsMatrix<real_t>& f);
 
 } // namespace internal
 
@@ -902,6 +902,38 @@ inline unsigned gsTensorBasis<d,Basis_t>::stride(short_t dir) const
     return s;
 }
 
+/// \brief Collects pointers to the univariate components of \a basis
+/// in \a comp, if \a basis is a tensor-product basis (of dimension
+/// at most four). Returns false otherwise.
+/// \ingroup Tensor
+template<class T>
+bool tensorComponents(const gsBasis<T> & basis,
+                      std::vector<const gsBasis<T>*> & comp)
+{
+    comp.clear();
+    switch ( basis.dim() )
+    {
+    case 1:
+        if ( nullptr != dynamic_cast<const gsTensorBasis<1,T>*>(&basis) )
+            comp.push_back(&basis);
+        break;
+    case 2:
+        if ( const gsTensorBasis<2,T> * tb = dynamic_cast<const gsTensorBasis<2,T>*>(&basis) )
+            for (short_t k = 0; k != 2; ++k) comp.push_back(&tb->component(k));
+        break;
+    case 3:
+        if ( const gsTensorBasis<3,T> * tb = dynamic_cast<const gsTensorBasis<3,T>*>(&basis) )
+            for (short_t k = 0; k != 3; ++k) comp.push_back(&tb->component(k));
+        break;
+    case 4:
+        if ( const gsTensorBasis<4,T> * tb = dynamic_cast<const gsTensorBasis<4,T>*>(&basis) )
+            for (short_t k = 0; k != 4; ++k) comp.push_back(&tb->component(k));
+        break;
+    default:
+        break;
+    }
+    return !comp.empty();
+}
 
 } // namespace gismo
 
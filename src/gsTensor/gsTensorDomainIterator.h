@@ -121,6 +121,7 @@ public:
     void reset()
     {
         curElement = meshStart;
+        m_id = 0;
         m_isGood = ( meshEnd.array() != meshStart.array() ).all() ;
         if (m_isGood)
             update();
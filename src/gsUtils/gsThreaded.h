@@ -51,6 +51,8 @@ public:
     /// Assigning to the local data
     C& operator = (C other) { return m_array[omp_get_thread_num()] = give(other); }
 #else
+    gsThreaded() : m_c() { }
+
     /// Casting to the local data
     operator C&()             { return m_c; }
     operator const C&() const { return m_c; }
@@ -0,0 +1,179 @@
+/** @file gsDistributedIetiSystem_test.cpp
+
+    @brief Compares the distributed IETI system with gsIetiSystem; runs
+    on any number of ranks
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#include "gismo_unittest.h"
+
+SUITE(gsDistributedIetiSystem_test)
+{
+
+// Sets up the ieti mapper for the given domain, with corners and edge
+// averages as primals
+void setupIetiMapper(const gsMultiPatch<> & mp, const gsMultiBasis<> & mb,
+                     gsBoundaryConditions<> & bc, gsIetiMapper<> & ietiMapper)
+{
+    gsExprAssembler<> assembler;
+    gsExprAssembler<>::space u = assembler.getSpace(mb);
+    bc.setGeoMap(mp);
+    u.setup(bc, dirichlet::interpolation, 0);
+    ietiMapper.init( mb, u.mapper(), u.fixedPart() );
+    ietiMapper.cornersAsPrimals();
+    ietiMapper.interfaceAveragesAsPrimals(mp, 1);
+    ietiMapper.computeJumpMatrices(true, true);
+}
+
+// Assembles the local problem for the patch k of the ieti mapper
+void assemblePatch(const gsMultiPatch<> & mp, const gsMultiBasis<> & mb,
+                   const gsBoundaryConditions<> & bc, gsIetiMapper<> & ietiMapper,
+                   index_t k, const gsFunctionExpr<> & f,
+                   gsSparseMatrix<> & localMatrix, gsMatrix<> & localRhs)
+{
+    gsBoundaryConditions<> bc_local;
+    bc.getConditionsForPatch(k,bc_local);
+    gsMultiPatch<> mp_local = mp[k];
+    gsMultiBasis<> mb_local = mb[k];
+
+    gsExprAssembler<> assembler(1,1);
+    assembler.setIntegrationElements(mb_local);
+    gsExprAssembler<>::geometryMap G = assembler.getMap(mp_local);
+    gsExprAssembler<>::space u = assembler.getSpace(mb_local);
+    bc_local.setGeoMap(mp_local);
+    u.setup(bc_local, dirichlet::interpolation, 0);
+    ietiMapper.initFeSpace(u,k);
+    auto ff = assembler.getCoeff(f, G);
+    assembler.initSystem();
+    assembler.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G), u * ff * meas(G) );
+    localMatrix = assembler.matrix();
+    localRhs = assembler.rhs();
+}
+
+TEST(DistributedSolve)
+{
+    gsMpi::init();
+    const gsMpiComm comm(gsMpi::worldComm());
+    const int rank = comm.rank(), nRanks = comm.size();
+
+    gsMultiPatch<> mp = gsNurbsCreator<>::BSplineSquareGrid(3, 3, 0.5);
+    const index_t nPatches = mp.nPatches();
+
+    gsFunctionExpr<> f("2*sin(x)*cos(y)", 2), gD("sin(x)*cos(y)", 2);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator it = mp.bBegin(); it < mp.bEnd(); ++it)
+        bc.addCondition(*it, condition_type::dirichlet, &gD);
+
+    // Reference: the whole domain on every rank
+    gsMultiBasis<> mb(mp);
+    mb.setDegree(2);
+    mb.uniformRefine(2);
+    gsIetiMapper<> ietiMapper;
+    setupIetiMapper(mp, mb, bc, ietiMapper);
+
+    gsIetiSystem<> ieti;
+    gsPrimalSystem<> primal(ietiMapper.nPrimalDofs());
+    for (index_t k=0; k<nPatches; ++k)
+    {
+        gsSparseMatrix<> localMatrix;
+        gsMatrix<> localRhs;
+        assemblePatch(mp, mb, bc, ietiMapper, k, f, localMatrix, localRhs);
+        gsSparseMatrix<real_t, RowMajor> jumpMatrix = ietiMapper.jumpMatrix(k);
+        primal.handleConstraints(ietiMapper.primalConstraints(k), ietiMapper.primalDofIndices(k),
+                                 jumpMatrix, localMatrix, localRhs);
+        ieti.addSubdomain(jumpMatrix.moveToPtr(), makeMatrixOp(localMatrix.moveToPtr()), give(localRhs));
+    }
+    ieti.addSubdomain(primal.jumpMatrix().moveToPtr(), makeMatrixOp(primal.localMatrix().moveToPtr()),
+                      give(primal.localRhs()));
+
+    const gsMatrix<> rhs = ieti.rhsForSchurComplement();
+    gsMatrix<> lambda, hist;
+    lambda.setZero(rhs.rows(), 1);
+    gsConjugateGradient<> PCG(ieti.schurComplement());
+    PCG.setTolerance(1e-12);
+    PCG.solveDetailed(rhs, lambda, hist);
+    const std::vector< gsMatrix<> > solutions = primal.distributePrimalSolution(
+        ieti.constructSolutionFromLagrangeMultipliers(lambda) );
+
+    // Distributed: every rank only sets up its patches and their neighbours
+    std::vector<index_t> ownedPatches;
+    for (index_t k=(nPatches * rank) / nRanks; k<(nPatches * (rank+1)) / nRanks; ++k)
+        ownedPatches.push_back(k);
+    const std::vector<index_t> patches = gsDistributedIetiSystem<>::neighborhood(mp, ownedPatches);
+    CHECK( patches.size() >= ownedPatches.size() && patches.size() <= (size_t)nPatches );
+    std::vector<int> ranks(patches.size());
+    for (size_t k=0; k<patches.size(); ++k)
+        for (ranks[k]=0; (nPatches * (ranks[k]+1)) / nRanks <= patches[k]; ++ranks[k]) {}
+
+    gsMultiPatch<> mpPart;
+    gsBoundaryConditions<> bcPart;
+    gsMultiBasis<> mbPart;
+    gsIetiMapper<> ietiMapperPart;
+    if (!patches.empty()) // more ranks than patches
+    {
+        gsDistributedIetiSystem<>::restrictToPatches(mp, bc, patches, mpPart, bcPart);
+        mbPart = gsMultiBasis<>(mpPart);
+        mbPart.setDegree(2);
+        mbPart.uniformRefine(2);
+        setupIetiMapper(mpPart, mbPart, bcPart, ietiMapperPart);
+    }
+
+    gsDistributedIetiSystem<> dieti(comm);
+    dieti.setupCommunication(ietiMapperPart, patches, ranks);
+    CHECK_EQUAL( ietiMapper.nLagrangeMultipliers(), dieti.nLagrangeMultipliers() );
+    CHECK_EQUAL( ietiMapper.nPrimalDofs(), dieti.nPrimalDofs() );
+    if (nRanks > 1 && !ownedPatches.empty())
+        CHECK( !dieti.neighbors().empty() );
+
+    gsScaledDirichletPrec<> prec;
+    gsPrimalSystem<> dprimal(dieti.nPrimalDofs());
+    for (size_t k=0; k<patches.size(); ++k)
+    {
+        if (ranks[k] != rank) continue;
+        gsSparseMatrix<> localMatrix;
+        gsMatrix<> localRhs;
+        assemblePatch(mpPart, mbPart, bcPart, ietiMapperPart, k, f, localMatrix, localRhs);
+        gsSparseMatrix<real_t, RowMajor> jumpMatrix = dieti.jumpMatrix(k);
+        prec.addSubdomain(gsScaledDirichletPrec<>::restrictToSkeleton(
+            jumpMatrix, localMatrix, ietiMapperPart.skeletonDofs(k)));
+        dprimal.handleConstraints(ietiMapperPart.primalConstraints(k), dieti.primalDofIndices(k),
+                                  jumpMatrix, localMatrix, localRhs);
+        dieti.addSubdomain(jumpMatrix.moveToPtr(), makeMatrixOp(localMatrix.moveToPtr()), give(localRhs));
+    }
+    dieti.addPrimalSubdomain(dprimal.jumpMatrix(), dprimal.localMatrix(), dprimal.localRhs());
+
+    // The norm of the right-hand side does not depend on the numbering of
+    // the Lagrange multipliers
+    const gsMatrix<> drhs = dieti.rhsForSchurComplement();
+    CHECK( math::abs(dieti.dot(drhs, drhs) - rhs.squaredNorm()) < 1e-10 * rhs.squaredNorm() );
+    CHECK_EQUAL( dieti.nLagrangeMultipliers(), dieti.globalMultipliers(drhs).rows() );
+
+    gsLinearOperator<>::Ptr precOp;
+    if (!ownedPatches.empty())
+    {
+        prec.setupMultiplicityScaling();
+        precOp = prec.preconditioner();
+    }
+    gsMatrix<> dlambda, dhist;
+    dlambda.setZero(dieti.nLocalLagrangeMultipliers(), 1);
+    CHECK( dieti.solve(dieti.distributedOp(precOp), drhs, dlambda, dhist, 1e-12, 100) );
+    const std::vector< gsMatrix<> > dsolutions = dprimal.distributePrimalSolution(
+        dieti.constructSolutionFromLagrangeMultipliers(dlambda) );
+
+    // The solutions on the patches of this rank agree with the reference
+    CHECK_EQUAL( ownedPatches.size(), dsolutions.size() );
+    for (size_t i=0; i<ownedPatches.size() && i<dsolutions.size(); ++i)
+    {
+        const gsMatrix<> & u = solutions[ownedPatches[i]];
+        CHECK( u.rows() == dsolutions[i].rows() && (u - dsolutions[i]).norm() < 1e-8 * u.norm() );
+    }
+}
+
+}
@@ -41,4 +41,463 @@ SUITE(gsExprAssembler_test)
                     const real_t v = ev.value();
                     CHECK( v*v < 1e-10 );
                 }
+
+         TEST(ScatterStrategies)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,2,1);
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(2);
+                    mb.uniformRefine(2);
+
+                    gsFunctionExpr<> ff("1", 2);
+                    gsBoundaryConditions<> bc;
+                    for (gsMultiPatch<>::const_biterator bit = patches.bBegin();
+                         bit != patches.bEnd(); ++bit)
+                        bc.addCondition(*bit, condition_type::dirichlet, ff);
+                    bc.setGeoMap(patches);
+
+                    gsSparseMatrix<> K[2];
+                    gsMatrix<> rhs[2];
+                    for (index_t s = 0; s != 2; ++s)
+                    {
+                        gsExprAssembler<> A(1,1);
+                        A.options().setInt("Scatter", s);
+                        A.setIntegrationElements(mb);
+                        gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                        gsExprAssembler<>::space u = A.getSpace(mb);
+                        auto f = A.getCoeff(ff, G);
+                        u.setup(bc, dirichlet::interpolation, 0);
+                        A.initSystem();
+                        A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G),
+                                    u * f * meas(G) );
+                        K[s]   = A.matrix();
+                        rhs[s] = A.rhs();
+                    }
+
+                    CHECK( (K[0]-K[1]).norm() < 1e-12 * K[0].norm() );
+                    CHECK( (rhs[0]-rhs[1]).norm() < 1e-12 * rhs[0].norm() );
+                }
+
+         TEST(ReusePattern)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,2,1);
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(2);
+                    mb.uniformRefine(2);
+
+                    gsFunctionExpr<> ff("1", 2);
+                    gsBoundaryConditions<> bc;
+                    for (gsMultiPatch<>::const_biterator bit = patches.bBegin();
+                         bit != patches.bEnd(); ++bit)
+                        bc.addCondition(*bit, condition_type::dirichlet, ff);
+                    bc.setGeoMap(patches);
+
+                    gsSparseMatrix<> K[2];
+                    for (index_t s = 0; s != 2; ++s)
+                    {
+                        gsExprAssembler<> A(1,1);
+                        A.options().setSwitch("ReusePattern", 1==s);
+                        A.setIntegrationElements(mb);
+                        gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                        gsExprAssembler<>::space u = A.getSpace(mb);
+                        u.setup(bc, dirichlet::interpolation, 0);
+                        A.initSystem();
+                        CHECK( A.hasPattern() == (1==s) );
+
+                        // Repeated assembly refills the same matrix
+                        for (index_t k = 0; k != 2; ++k)
+                        {
+                            A.clearMatrix();
+                            A.clearRhs();
+                            A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                        }
+                        K[s] = A.matrix();
+                    }
+
+                    CHECK( (K[0]-K[1]).norm() < 1e-12 * K[0].norm() );
+                }
+
+         TEST(MatrixFreeApply)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,1,1);
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(3);
+                    mb.uniformRefine(2);
+
+                    gsFunctionExpr<> ff("1", 2);
+                    gsBoundaryConditions<> bc;
+                    for (gsMultiPatch<>::const_biterator bit = patches.bBegin();
+                         bit != patches.bEnd(); ++bit)
+                        bc.addCondition(*bit, condition_type::dirichlet, ff);
+                    bc.setGeoMap(patches);
+
+                    gsExprAssembler<> A(1,1);
+                    A.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                    gsExprAssembler<>::space u = A.getSpace(mb);
+                    u.setup(bc, dirichlet::interpolation, 0);
+                    A.initSystem();
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+
+                    gsMatrix<> x, y;
+                    x.setRandom(A.numDofs(), 2);
+                    A.matrixFreeApply(x, y, igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    CHECK( (A.matrix()*x - y).norm() < 1e-12 * y.norm() );
+
+                    gsLinearOperator<>::uPtr op =
+                        A.matrixFreeOperator( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    CHECK_EQUAL( A.numDofs(), op->rows() );
+                    op->apply(x, y);
+                    CHECK( (A.matrix()*x - y).norm() < 1e-12 * y.norm() );
+                }
+
+         TEST(BatchedQuadrature)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,1,1);
+                    patches.patch(1).coefs().col(1).array() +=
+                        0.2 * patches.patch(1).coefs().col(0).array().square();
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(3);
+                    mb.uniformRefine(2);
+
+                    gsFunctionExpr<> ff("x*y", 2);
+                    gsExprAssembler<> A(1,1);
+                    A.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                    gsExprAssembler<>::space u = A.getSpace(mb);
+                    auto f = A.getCoeff(ff, G);
+                    A.initSystem();
+
+                    // Batched over the quadrature points of each element
+                    A.options().setSwitch("BatchQuadrature", true);
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) + u * u.tr() * meas(G),
+                                u * f * meas(G) );
+                    const gsSparseMatrix<> K0 = A.matrix();
+                    const gsMatrix<>       r0 = A.rhs();
+
+                    // Same forms, summed point by point
+                    A.options().setSwitch("BatchQuadrature", false);
+                    A.initSystem();
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) + u * u.tr() * meas(G),
+                                u * f * meas(G) );
+                    CHECK( (K0-A.matrix()).norm() < 1e-12 * K0.norm() );
+                    CHECK( (r0-A.rhs()).norm() < 1e-12 * r0.norm() );
+                }
+
+         TEST(CacheMaps)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,2,1);
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(2);
+                    mb.uniformRefine(2);
+
+                    gsExprAssembler<> A(1,1);
+                    A.options().setSwitch("CacheMaps", true);
+                    A.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                    gsExprAssembler<>::space u = A.getSpace(mb);
+                    A.initSystem();
+
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    const gsSparseMatrix<> K0 = A.matrix();
+                    A.clearMatrix();
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    CHECK( (K0-A.matrix()).norm() < 1e-12 * K0.norm() );
+
+                    // The geometry changes: the cache must be cleared
+                    patches.patch(0).coefs().col(0) *= 2.0;
+                    A.clearMapCache();
+                    A.clearMatrix();
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    const gsSparseMatrix<> K1 = A.matrix();
+
+                    A.options().setSwitch("CacheMaps", false);
+                    A.clearMatrix();
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    CHECK( (K1-A.matrix()).norm() < 1e-12 * K1.norm() );
+                    CHECK( (K0-K1).norm() > 1e-3 * K0.norm() );
+                }
+
+         TEST(FiniteDifferenceJacobian)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,2,1);
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(2);
+                    mb.uniformRefine(2);
+
+                    gsExprAssembler<> A(1,1);
+                    A.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                    gsExprAssembler<>::space u = A.getSpace(mb);
+                    A.initSystem();
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    const gsSparseMatrix<> K = A.matrix();
+
+                    gsMatrix<> x;
+                    x.setRandom(A.numDofs(), 1);
+                    const gsMatrix<> x0 = x;
+                    gsExprAssembler<>::solution s = A.getSolution(u, x);
+
+                    // Elements sharing coefficients are never perturbed concurrently
+                    A.initSystem();
+                    A.assembleJacobian( igrad(u, G) * igrad(s, G).tr() * meas(G), s );
+                    CHECK( (K-A.matrix()).norm() < 1e-8 * K.norm() );
+                    CHECK( (x0-x).norm() < 1e-12 );
+                }
+
+         TEST(IncrementalAssembly)
+                {
+                    gsMultiPatch<> patches( *gsNurbsCreator<>::BSplineSquare(1.0) );
+                    patches.patch(0).coefs().col(1).array() +=
+                        0.2 * patches.patch(0).coefs().col(0).array().square();
+                    gsTensorBSplineBasis<2> tb(
+                        static_cast<const gsTensorBSplineBasis<2>&>(patches.basis(0)) );
+                    tb.setDegree(2);
+                    tb.uniformRefine(15);
+                    gsTHBSplineBasis<2> thb(tb);
+                    gsMultiBasis<> mb(thb);
+
+                    gsFunctionExpr<> ff("x*y", 2), gg("1+x", 2);
+                    gsBoundaryConditions<> bc;
+                    for (gsMultiPatch<>::const_biterator bit = patches.bBegin();
+                         bit != patches.bEnd(); ++bit)
+                        bc.addCondition(*bit, condition_type::dirichlet, gg);
+                    bc.setGeoMap(patches);
+
+                    gsExprAssembler<> A(1,1), B(1,1);
+                    A.setIntegrationElements(mb);
+                    B.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap GA = A.getMap(patches), GB = B.getMap(patches);
+                    gsExprAssembler<>::space uA = A.getSpace(mb), uB = B.getSpace(mb);
+                    auto fA = A.getCoeff(ff, GA);
+                    auto fB = B.getCoeff(ff, GB);
+
+                    gsMatrix<> box(2,2);
+                    box << 0, 0.125, 0, 0.125;
+                    for (index_t k = 0; k != 3; ++k)
+                    {
+                        // Refine locally around a corner
+                        if (k > 0)
+                            mb.basis(0).refine(box / k);
+                        uA.setup(bc, dirichlet::interpolation, 0);
+                        uB.setup(bc, dirichlet::interpolation, 0);
+                        A.initSystem();
+                        B.initSystem();
+                        A.assembleIncremental( igrad(uA, GA) * igrad(uA, GA).tr() * meas(GA),
+                                               uA * fA * meas(GA) );
+                        B.assemble( igrad(uB, GB) * igrad(uB, GB).tr() * meas(GB),
+                                    uB * fB * meas(GB) );
+                        CHECK_EQUAL( B.numDofs(), A.numDofs() );
+                        CHECK( (B.matrix()-A.matrix()).norm() < 1e-12 * B.matrix().norm() );
+                        CHECK( (B.rhs()-A.rhs()).norm() < 1e-12 * B.rhs().norm() );
+                    }
+                }
+
+         TEST(Profile)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,1,1);
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(2);
+                    mb.uniformRefine(2);
+
+                    gsExprAssembler<> A(1,1);
+                    A.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                    gsExprAssembler<>::space u = A.getSpace(mb);
+                    A.initSystem();
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    CHECK( !A.profile().enabled() );
+
+                    A.options().setSwitch("Profile", true);
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G), u * meas(G) );
+                    const index_t nEl = mb.totalElements();
+                    const gsAssemblyProfile & prof = A.profile();
+                    CHECK( prof.enabled() );
+                    CHECK_EQUAL( nEl, prof.total(gsAssemblyProfile::quadrature).calls );
+                    CHECK_EQUAL( nEl, prof.total(gsAssemblyProfile::precompute).calls );
+                    CHECK_EQUAL( 2*nEl, prof.total(gsAssemblyProfile::evaluate).calls );
+                    CHECK_EQUAL( 2*nEl, prof.total(gsAssemblyProfile::push).calls );
+                    CHECK( prof.total(gsAssemblyProfile::evaluate).flops > 0 );
+                    CHECK( prof.total(gsAssemblyProfile::precompute).bytes > 0 );
+
+                    // Counters are accumulated over the calls
+                    A.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) );
+                    CHECK_EQUAL( 2*nEl, prof.total(gsAssemblyProfile::quadrature).calls );
+                    A.resetProfile();
+                    CHECK_EQUAL( 0, prof.total(gsAssemblyProfile::quadrature).calls );
+                }
+
+         TEST(DeterministicReduction)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,2,1);
+                    gsMultiBasis<> mb(patches);
+                    mb.uniformRefine(3);
+
+                    gsFunctionExpr<> ff("sin(3*x)*exp(y)", 2);
+                    gsExprEvaluator<> ev;
+                    ev.options().setInt("ElementChunk", 1);
+                    ev.setIntegrationElements(mb);
+                    gsExprEvaluator<>::geometryMap G = ev.getMap(patches);
+                    auto f = ev.getVariable(ff, G);
+
+                    // With one element per work item, the result is the
+                    // pairwise sum of the element values, for any number
+                    // of threads
+                    ev.integralElWise(f * meas(G));
+                    std::vector<real_t> v = ev.elementwise();
+                    for (size_t s = 1; s < v.size(); s *= 2)
+                        for (size_t i = 0; i + s < v.size(); i += 2*s)
+                            v[i] += v[i+s];
+
+                    for (index_t k = 0; k != 3; ++k)
+                        CHECK_EQUAL( v.front(), ev.integral(f * meas(G)) );
+                }
+
+         TEST(BatchedPointEvaluation)
+                {
+                    gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2,1,1);
+                    patches.patch(1).coefs().col(1).array() +=
+                        0.2 * patches.patch(1).coefs().col(0).array().square();
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(2);
+                    mb.uniformRefine(3);
+
+                    gsExprAssembler<> A(1,1);
+                    A.setIntegrationElements(mb);
+                    gsExprAssembler<>::space u = A.getSpace(mb);
+                    A.initSystem();
+                    gsMatrix<> x;
+                    x.setRandom(A.numDofs(), 1);
+                    gsExprAssembler<>::solution s = A.getSolution(u, x);
+
+                    gsExprEvaluator<> ev(A);
+                    gsExprEvaluator<>::geometryMap G = ev.getMap(patches);
+
+                    // Several points per element, in random order
+                    const index_t np = 500;
+                    gsMatrix<> pts = 0.5 * (gsMatrix<>::Random(2, np).array() + 1);
+                    pts.rightCols(np/2) = pts.leftCols(np/2);
+                    gsVector<index_t> pid(np);
+                    for (index_t i = 0; i != np; ++i)
+                        pid[i] = i % 2;
+
+                    const gsMatrix<> v = ev.evalBatch(igrad(s, G), pts, pid);
+                    const gsMatrix<> w = ev.evalBatch(s * meas(G), pts, pid);
+                    CHECK_EQUAL( 2, v.rows() );
+                    CHECK_EQUAL( np, v.cols() );
+                    for (index_t i = 0; i != np; ++i)
+                    {
+                        const gsVector<> pt = pts.col(i);
+                        CHECK( (v.col(i) - ev.eval(igrad(s, G), pt, pid[i])).norm() < 1e-12 );
+                        CHECK( math::abs(w(0,i) - ev.eval(s * meas(G), pt, pid[i])(0,0)) < 1e-12 );
+                    }
+                }
+
+         TEST(Collocation)
+                {
+                    gsMultiPatch<> patches( *gsNurbsCreator<>::BSplineSquare(1.0) );
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(4);
+                    mb.uniformRefine(7);
+
+                    gsFunctionExpr<> ff("2*pi^2*sin(pi*x)*sin(pi*y)", 2),
+                        uu("sin(pi*x)*sin(pi*y)", 2);
+                    gsBoundaryConditions<> bc;
+                    for (gsMultiPatch<>::const_biterator bit = patches.bBegin();
+                         bit != patches.bEnd(); ++bit)
+                        bc.addCondition(*bit, condition_type::dirichlet, uu);
+                    bc.setGeoMap(patches);
+
+                    gsExprAssembler<> A(1,1);
+                    A.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                    gsExprAssembler<>::space u = A.getSpace(mb);
+                    auto f = A.getCoeff(ff, G);
+                    u.setup(bc, dirichlet::interpolation, 0);
+                    A.initSystem();
+                    A.collocate( -ilapl(u, G), f );
+                    CHECK_EQUAL( A.numDofs(), A.matrix().rows() );
+
+                    gsSparseSolver<>::LU solver(A.matrix());
+                    gsMatrix<> x = solver.solve(A.rhs());
+                    gsExprAssembler<>::solution s = A.getSolution(u, x);
+
+                    gsExprEvaluator<> ev(A);
+                    auto ue = ev.getVariable(uu, G);
+                    CHECK( math::sqrt(ev.integral((s - ue).sqNorm() * meas(G))) < 1e-4 );
+                }
+
+         TEST(FixedDimKernels)
+                {
+                    // Small blocks, compared with the products of dynamic size
+                    for (index_t d = 2; d <= 4; ++d)
+                    {
+                        const index_t nb = 5, nbv = 4;
+                        gsMatrix<> A, B, C, res, ref;
+                        A.setRandom(d, nb*d);
+                        B.setRandom(d, d);
+                        C.setRandom(d, nbv*d);
+
+                        res.resize(d, nb*d);
+                        ref.resize(d, nb*d);
+                        for (index_t i = 0; i!=nb; ++i)
+                            ref.middleCols(i*d,d) = A.middleCols(i*d,d) * B;
+                        CHECK_EQUAL( d<4, expr::fixed_dim<real_t>::blockMult(A, B, res, nb) );
+                        if (d<4) CHECK( (res-ref).norm() < 1e-12 * ref.norm() );
+
+                        res.resize(nb*d, nbv*d);
+                        ref.resize(nb*d, nbv*d);
+                        for (index_t i = 0; i!=nb; ++i)
+                            for (index_t j = 0; j!=nbv; ++j)
+                                ref.block(i*d,j*d,d,d) = A.middleCols(i*d,d) * C.middleCols(j*d,d);
+                        CHECK_EQUAL( d<4, expr::fixed_dim<real_t>::blockPairs(A, C, res, d) );
+                        if (d<4) CHECK( (res-ref).norm() < 1e-12 * ref.norm() );
+
+                        res.resize(nb, nbv);
+                        ref.resize(nb, nbv);
+                        for (index_t i = 0; i!=nb; ++i)
+                            for (index_t j = 0; j!=nbv; ++j)
+                                ref(i,j) = (A.middleCols(i*d,d).array() *
+                                            C.middleCols(j*d,d).array()).sum();
+                        CHECK_EQUAL( d<4, expr::fixed_dim<real_t>::frobenius(A, C, res, d) );
+                        if (d<4) CHECK( (res-ref).norm() < 1e-12 * ref.norm() );
+                    }
+
+                    // 3D vector-valued form (ijac uses blockMult, % uses
+                    // frobenius), compared with the scalar form per component
+                    gsMultiPatch<> patches( *gsNurbsCreator<>::BSplineCube(1.0) );
+                    gsMatrix<> & c = patches.patch(0).coefs();
+                    c.col(2).array() += 0.2 * c.col(0).array() * c.col(1).array();
+                    gsMultiBasis<> mb(patches);
+                    mb.setDegree(2);
+                    mb.uniformRefine(2);
+
+                    gsExprAssembler<> A(1,1);
+                    A.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap G = A.getMap(patches);
+                    gsExprAssembler<>::space w = A.getSpace(mb, 3);
+                    A.initSystem();
+                    gsMatrix<> x;
+                    x.setRandom(A.numDofs(), 1);
+                    gsExprAssembler<>::solution s = A.getSolution(w, x);
+                    A.assemble( ijac(w, G) % ijac(s, G) * meas(G) );
+
+                    gsExprAssembler<> B(1,1);
+                    B.setIntegrationElements(mb);
+                    gsExprAssembler<>::geometryMap H = B.getMap(patches);
+                    gsExprAssembler<>::space u = B.getSpace(mb);
+                    B.initSystem();
+                    gsMatrix<> xc(B.numDofs(), 1);
+                    gsExprAssembler<>::solution sc = B.getSolution(u, xc);
+                    for (index_t d = 0; d!=3; ++d)
+                    {
+                        for (index_t i = 0; i!=mb.size(); ++i)
+                            xc(u.mapper().index(i,0)) = x(w.mapper().index(i,0,d));
+                        B.initVector();
+                        B.assemble( igrad(u, H) * igrad(sc, H).tr() * meas(H) );
+                        for (index_t i = 0; i!=mb.size(); ++i)
+                            CHECK_CLOSE( B.rhs()(u.mapper().index(i,0)),
+                                         A.rhs()(w.mapper().index(i,0,d)), 1e-12 );
+                    }
+                }
         }
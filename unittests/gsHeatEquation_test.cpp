@@ -0,0 +1,85 @@
+/** @file gsHeatEquation_test.cpp
+
+    @brief Tests the time steps of gsHeatEquation
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#include "gismo_unittest.h"
+
+SUITE(gsHeatEquation_test)
+{
+
+// Relative difference of the system of the last time step to the
+// uncached time step with the current stationary matrix
+real_t uncachedDiff(gsHeatEquation<real_t> & heat, const gsMatrix<real_t> & u,
+                    const real_t dt)
+{
+    const gsSparseMatrix<real_t> A = heat.matrix();
+    const gsMatrix<real_t>       b = heat.rhs();
+
+    heat.nextTimeStepFixedRhs(heat.stationaryMatrix(), heat.mass(),
+                              heat.stationaryRhs(), u, dt);
+    const gsSparseMatrix<real_t> dA = A - heat.matrix();
+
+    return dA.norm() / heat.matrix().norm()
+        + (b - heat.rhs()).norm() / heat.rhs().norm();
+}
+
+TEST(CachedTimeStep)
+{
+    gsMultiPatch<real_t> mp( *gsNurbsCreator<real_t>::BSplineSquare(1.0, 0.0, 0.0) );
+    gsMultiBasis<real_t> mb(mp);
+    mb.setDegree(2);
+    mb.uniformRefine(3);
+
+    gsFunctionExpr<real_t> f("2*pi^2*sin(pi*x)*sin(pi*y)", 2);
+    gsFunctionExpr<real_t> g("0", 2);
+    gsBoundaryConditions<real_t> bc;
+    for (gsMultiPatch<real_t>::const_biterator it = mp.bBegin(); it != mp.bEnd(); ++it)
+        bc.addCondition(*it, condition_type::dirichlet, &g);
+
+    gsPoissonPde<real_t> pde(mp, bc, f);
+    gsPoissonAssembler<real_t> stationary(pde, mb);
+    gsHeatEquation<real_t> heat(stationary);
+    heat.setTheta(0.5);
+    heat.assemble();
+
+    gsMatrix<real_t> u;
+    u.setRandom(heat.numDofs(), 1);
+    const real_t dt = 0.01;
+
+    // First step forms the system matrix, the second one reuses it
+    CHECK( heat.nextTimeStep(u, dt) );
+    CHECK( uncachedDiff(heat, u, dt) < 1e-12 );
+    CHECK( heat.nextTimeStep(u, dt) );
+    CHECK( !heat.nextTimeStep(u, dt) );
+    const gsSparseMatrix<real_t> A0 = heat.matrix();
+    CHECK( uncachedDiff(heat, u, dt) < 1e-12 );
+
+    // Re-assemble the stationary problem on a deformed domain, same
+    // sparsity pattern and storage
+    const size_t rev = stationary.revision();
+    pde.patches().patch(0).coefs().col(0).array() *= 2.0;
+    stationary.assemble();
+    CHECK( rev != stationary.revision() );
+
+    CHECK( heat.nextTimeStep(u, dt) );
+    const gsSparseMatrix<real_t> dA = heat.matrix() - A0;
+    CHECK( dA.norm() > 1e-3 * A0.norm() );
+    CHECK( uncachedDiff(heat, u, dt) < 1e-12 );
+
+    // Cached again after the refresh, until the step size changes
+    CHECK( heat.nextTimeStep(u, dt) );
+    CHECK( !heat.nextTimeStep(u, dt) );
+    CHECK( heat.nextTimeStep(u, 2*dt) );
+    CHECK( uncachedDiff(heat, u, 2*dt) < 1e-12 );
+}
+
+}
@@ -0,0 +1,164 @@
+/** @file gsIetiSystem_test.cpp
+
+    @brief Tests the updates of the local solvers of the IETI system and
+    of the scaled Dirichlet preconditioner for new values of the local
+    matrices
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#include "gismo_unittest.h"
+
+SUITE(gsIetiSystem_test)
+{
+
+// The local stiffness matrices of -div(grad u) + c u on the patches of a
+// 2x2 grid, with Dirichlet conditions on the whole boundary (such that
+// no primal degrees of freedom are needed). The sparsity patterns do
+// not depend on c.
+struct IetiProblem
+{
+    explicit IetiProblem(int numRefine = 2)
+    : mp(gsNurbsCreator<>::BSplineSquareGrid(2, 2, 0.5)), mb(mp), gD("sin(x)*cos(y)", 2)
+    {
+        mb.setDegree(2);
+        for (int i=0; i<numRefine; ++i)
+            mb.uniformRefine();
+
+        for (gsMultiPatch<>::const_biterator it = mp.bBegin(); it < mp.bEnd(); ++it)
+            bc.addCondition(*it, condition_type::dirichlet, &gD);
+        bc.setGeoMap(mp);
+
+        gsExprAssembler<> assembler;
+        gsExprAssembler<>::space u = assembler.getSpace(mb);
+        u.setup(bc, dirichlet::interpolation, 0);
+        ietiMapper.init( mb, u.mapper(), u.fixedPart() );
+        ietiMapper.computeJumpMatrices(true, true);
+    }
+
+    gsSparseMatrix<> localMatrix(index_t k, real_t c)
+    {
+        gsBoundaryConditions<> bc_local;
+        bc.getConditionsForPatch(k,bc_local);
+        gsMultiPatch<> mp_local = mp[k];
+        gsMultiBasis<> mb_local = mb[k];
+
+        gsExprAssembler<> assembler(1,1);
+        assembler.setIntegrationElements(mb_local);
+        gsExprAssembler<>::geometryMap G = assembler.getMap(mp_local);
+        gsExprAssembler<>::space u = assembler.getSpace(mb_local);
+        bc_local.setGeoMap(mp_local);
+        u.setup(bc_local, dirichlet::interpolation, 0);
+        assembler.initSystem();
+        assembler.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G) + c * u * u.tr() * meas(G) );
+        return assembler.matrix();
+    }
+
+    gsMultiPatch<> mp;
+    gsMultiBasis<> mb;
+    gsFunctionExpr<> gD;
+    gsBoundaryConditions<> bc;
+    gsIetiMapper<> ietiMapper;
+};
+
+// Relative difference of two operators, applied to the same vectors
+real_t applyDiff(const gsLinearOperator<> & A, const gsLinearOperator<> & B)
+{
+    gsMatrix<> x(A.cols(), 2), y, z;
+    for (index_t i=0; i<x.size(); ++i)
+        x.data()[i] = (real_t)((i*7) % 11) - 5;
+    A.apply(x, y);
+    B.apply(x, z);
+    return (y - z).norm() / z.norm();
+}
+
+TEST(RefactorizeLocalSolvers)
+{
+    IetiProblem pb;
+    const index_t nPatches = pb.mp.nPatches();
+
+    gsIetiSystem<> ieti, fresh;
+    std::vector< gsSparseMatrix<>::Ptr > matrices(nPatches);
+    for (index_t k=0; k<nPatches; ++k)
+    {
+        matrices[k] = pb.localMatrix(k, 1).moveToPtr();
+        gsMatrix<> rhs;
+        rhs.setZero(matrices[k]->rows(), 1);
+        gsSparseMatrix<real_t,RowMajor> jumpMatrix = pb.ietiMapper.jumpMatrix(k);
+        ieti.addSubdomain(jumpMatrix.moveToPtr(), makeMatrixOp(matrices[k]), rhs);
+        jumpMatrix = pb.ietiMapper.jumpMatrix(k);
+        fresh.addSubdomain(jumpMatrix.moveToPtr(), makeMatrixOp(pb.localMatrix(k, 5).moveToPtr()), rhs);
+    }
+    gsLinearOperator<>::Ptr F = ieti.schurComplement(), freshF = fresh.schurComplement();
+    CHECK( applyDiff(*F, *freshF) > 1e-6 );
+
+    // New values of the local matrices, in place
+    for (index_t k=0; k<nPatches; ++k)
+        *matrices[k] = pb.localMatrix(k, 5);
+    ieti.refactorizeLocalSolvers();
+
+    CHECK( applyDiff(*F, *freshF) < 1e-10 );
+    CHECK( applyDiff(*ieti.schurComplement(), *freshF) < 1e-10 );
+}
+
+TEST(UpdateLocalMatrix)
+{
+    IetiProblem pb;
+    const index_t nPatches = pb.mp.nPatches();
+
+    gsScaledDirichletPrec<> prec, fresh;
+    for (index_t k=0; k<nPatches; ++k)
+    {
+        const std::vector<index_t> dofs = pb.ietiMapper.skeletonDofs(k);
+        prec.addSubdomain(pb.ietiMapper.jumpMatrix(k), pb.localMatrix(k, 1), dofs);
+        fresh.addSubdomain(pb.ietiMapper.jumpMatrix(k), pb.localMatrix(k, 5), dofs);
+    }
+    prec.setupMultiplicityScaling();
+    fresh.setupMultiplicityScaling();
+    gsLinearOperator<>::Ptr P = prec.preconditioner(), freshP = fresh.preconditioner();
+    CHECK( applyDiff(*P, *freshP) > 1e-6 );
+
+    for (index_t k=0; k<nPatches; ++k)
+        prec.updateLocalMatrix(k, pb.localMatrix(k, 5));
+
+    // Both, the local Schur complements and the preconditioner set up
+    // before the update reflect the new values
+    for (index_t k=0; k<nPatches; ++k)
+        CHECK( applyDiff(*prec.localSchurOps(k), *fresh.localSchurOps(k)) < 1e-10 );
+    CHECK( applyDiff(*P, *freshP) < 1e-10 );
+    CHECK( applyDiff(*prec.preconditioner(), *freshP) < 1e-10 );
+}
+
+TEST(DenseSchurComplements)
+{
+    // Enough skeleton dofs for several blocks of right-hand sides
+    IetiProblem pb(5);
+    const index_t nPatches = pb.mp.nPatches();
+
+    gsScaledDirichletPrec<> prec;
+    for (index_t k=0; k<nPatches; ++k)
+        prec.addSubdomain(pb.ietiMapper.jumpMatrix(k), pb.localMatrix(k, 1), pb.ietiMapper.skeletonDofs(k));
+    prec.setupDenseSchurComplements();
+
+    for (index_t k=0; k<nPatches; ++k)
+    {
+        const std::vector<index_t> dofs = pb.ietiMapper.skeletonDofs(k);
+        CHECK( dofs.size() > 64 );
+        CHECK( dynamic_cast<const gsMatrixOp<gsMatrix<> >*>(prec.localSchurOps(k).get()) );
+        CHECK( applyDiff(*prec.localSchurOps(k),
+                         *gsScaledDirichletPrec<>::schurComplement(pb.localMatrix(k, 1), dofs)) < 1e-10 );
+
+        // The dense matrix is assembled again for the new values
+        prec.updateLocalMatrix(k, pb.localMatrix(k, 5));
+        CHECK( applyDiff(*prec.localSchurOps(k),
+                         *gsScaledDirichletPrec<>::schurComplement(pb.localMatrix(k, 5), dofs)) < 1e-10 );
+    }
+}
+
+}
@@ -249,6 +249,40 @@ SUITE(gsIterativeSolvers_test)
         CHECK( (mat*x-rhs).norm()/rhs.norm() <= tol );
     }
 
+    TEST(CG_Pipelined_test)
+    {
+        index_t          N = 100;
+        real_t           tol = std::pow(10.0, - REAL_DIG * 0.5);
+
+        gsSparseMatrix<> mat;
+        gsMatrix<>       rhs;
+        gsMatrix<>       x, x_ref;
+
+        poissonDiscretization(mat, rhs, N);
+
+        gsOptionList opt = gsConjugateGradient<>::defaultOptions();
+        opt.setInt   ("MaxIterations"  , N   );
+        opt.setReal  ("Tolerance"      , tol );
+        opt.setSwitch("CalcEigenvalues", true);
+
+        gsLinearOperator<>::Ptr precon = makeSymmetricGaussSeidelOp(mat);
+        gsConjugateGradient<> solver_ref(mat,precon);
+        solver_ref.setOptions(opt);
+        x_ref.setZero(N,1);
+        solver_ref.solve(rhs,x_ref);
+
+        opt.setSwitch("Pipelined", true);
+        gsConjugateGradient<> solver(mat,precon);
+        solver.setOptions(opt);
+        x.setZero(N,1);
+        solver.solve(rhs,x);
+
+        CHECK( (mat*x-rhs).norm()/rhs.norm() <= 10*tol );
+        // In exact arithmetic, both variants coincide
+        CHECK_CLOSE( solver.iterations(), solver_ref.iterations(), 1 );
+        CHECK_CLOSE( solver.getConditionNumber(), solver_ref.getConditionNumber(), 1e-4*solver_ref.getConditionNumber() );
+    }
+
     TEST(GMRES_GS_test)
     {
         index_t          N = 100;
@@ -61,6 +61,36 @@ SUITE(gsKronecker_test)
         CHECK_EQUAL ( y, KP * x );
     }
 
+    TEST(gsKroneckerOpModes)
+    {
+        // dense, transposed and sparse factors, several right-hand sides
+        gsSparseMatrix<> sB = B.sparseView();
+        gsMatrix<> C = (gsMatrix<>(2,2) << 1, -2, 3, 4).finished();
+        gsKroneckerOp<> kron( makeMatrixOp(A), makeMatrixOp(C.transpose()), makeMatrixOp(sB) );
+        CHECK( kron.matrixFactors() );
+        gsMatrix<> y, x(18,2);
+        for (index_t i = 0; i < x.size(); ++i)
+            x.data()[i] = (real_t)((i * 7) % 11) - 5;
+        kron.apply(x, y);
+        const gsMatrix<> K = A.kron(C.transpose()).kron(B);
+        CHECK( (y - K * x).norm() <= 1e-12 * (K * x).norm() );
+
+        // transposes of const matrices, sparse ones
+        const gsMatrix<> & cC = C;
+        const gsSparseMatrix<> sBt = B.transpose().sparseView();
+        gsKroneckerOp<> kron1( makeMatrixOp(A), makeMatrixOp(cC.transpose()), makeMatrixOp(sBt.transpose()) );
+        CHECK( kron1.matrixFactors() );
+        kron1.apply(x, y);
+        CHECK( (y - K * x).norm() <= 1e-12 * (K * x).norm() );
+
+        // with an operator which is not a matrix
+        gsKroneckerOp<> kron2( makeMatrixOp(A), gsIdentityOp<>::make(2), makeMatrixOp(B) );
+        CHECK( !kron2.matrixFactors() );
+        kron2.apply(x, y);
+        const gsMatrix<> K2 = A.kron(gsMatrix<>::Identity(2,2)).kron(B);
+        CHECK( (y - K2 * x).norm() <= 1e-12 * (K2 * x).norm() );
+    }
+
     TEST(DenseKronecker)
     {        
         gsMatrix<> C = A.kron(B);
@@ -46,4 +46,37 @@ SUITE(gsMatrixOp_test)
         CHECK( ( A.transpose() - C ).norm() <= 1.e-10 );
     }
 
+    TEST(SolverOpFactorize)
+    {
+        const index_t n = 10;
+        gsSparseMatrix<> A(n,n), B(n,n);
+        for (index_t i=0; i<n; ++i)
+        {
+            A(i,i) = 4; B(i,i) = 3 + i;
+            if (i>0)
+            {
+                A(i,i-1) = -1; A(i-1,i) = -1;
+                B(i,i-1) = -2; B(i-1,i) = -2;
+            }
+        }
+        A.makeCompressed(); B.makeCompressed();
+
+        gsMatrix<> x(n,2), y, z;
+        for (index_t i=0; i<x.size(); ++i)
+            x.data()[i] = (real_t)((i*7) % 11) - 5;
+
+        // Same sparsity pattern, new values
+        gsSolverOp<gsSparseSolver<>::LU>::uPtr lu = makeSparseLUSolver(A);
+        lu->factorize(B);
+        lu->apply(x, y);
+        makeSparseLUSolver(B)->apply(x, z);
+        CHECK( ( B*y - x ).norm() <= 1.e-10 * x.norm() );
+        CHECK( ( y - z ).norm() <= 1.e-10 * z.norm() );
+
+        gsSolverOp<gsSparseSolver<>::SimplicialLDLT>::uPtr ldlt = makeSparseCholeskySolver(A);
+        ldlt->factorize(B);
+        ldlt->apply(x, y);
+        CHECK( ( B*y - x ).norm() <= 1.e-10 * x.norm() );
+    }
+
 }
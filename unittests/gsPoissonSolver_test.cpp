@@ -167,6 +167,36 @@ SUITE(gsPoissonSolver_test)
         runPoissonSolverTest(dirichlet::nitsche, iFace::dg, 0);
         runPoissonSolverTest(dirichlet::nitsche, iFace::dg, 1);
     }
-    
+
+    TEST(ScatterStrategies)
+    {
+        gsFunctionExpr<> f("((pi*1)^2 + (pi*2)^2)*sin(pi*x*1)*sin(pi*y*2)",2);
+        gsFunctionExpr<> g("sin(pi*x*1)*sin(pi*y*2)+pi/10",2);
+        gsMultiPatch<> patches = gsNurbsCreator<>::BSplineSquareGrid(2, 2, 0.5);
+        gsBoundaryConditions<> bcInfo;
+        for (gsMultiPatch<>::const_biterator bit = patches.bBegin();
+             bit != patches.bEnd(); ++bit)
+            bcInfo.addCondition(*bit, condition_type::dirichlet, &g);
+        gsMultiBasis<> bases(patches);
+        bases.uniformRefine(3);
+
+        // Critical section and thread-local systems give the same
+        // system, also with the Nitsche and dG terms pushed after the
+        // thread-local systems have been merged
+        gsSparseMatrix<> K[2];
+        gsMatrix<> rhs[2];
+        for (index_t s = 0; s != 2; ++s)
+        {
+            gsPoissonAssembler<real_t> poisson(patches,bases,bcInfo,f,
+                                               dirichlet::nitsche,iFace::dg);
+            poisson.options().setInt("Scatter", s);
+            poisson.assemble();
+            K[s]   = poisson.matrix();
+            rhs[s] = poisson.rhs();
+        }
+        CHECK( (K[0]-K[1]).norm() < 1e-12 * K[0].norm() );
+        CHECK( (rhs[0]-rhs[1]).norm() < 1e-12 * rhs[0].norm() );
+    }
+
 }
 
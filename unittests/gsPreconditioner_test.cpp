@@ -87,6 +87,44 @@ void runPreconditionerTest( index_t testcase )
         solver.solve(rhs,sol);
         CHECK ( solver.error() <= solver.tolerance() );
     }
+    else if (testcase==4)
+    {
+        typedef gsMultiColorGaussSeidelOp<gsSparseMatrix<>,gsGaussSeidel::symmetric> MCGS;
+        MCGS::Ptr mcgs = MCGS::make(mat);
+
+        // Rows of the same color must not be coupled
+        gsVector<index_t> colorOf(mat.rows());
+        for (index_t c = 0; c < mcgs->numColors(); ++c)
+            for (size_t r = 0; r != mcgs->color(c).size(); ++r)
+                colorOf[ mcgs->color(c)[r] ] = c;
+        for (index_t i = 0; i < mat.outerSize(); ++i)
+            for (gsSparseMatrix<>::InnerIterator it(mat,i); it; ++it)
+                CHECK( it.index() == i || colorOf[it.index()] != colorOf[i] );
+
+        gsConjugateGradient<> solver(mat, mcgs);
+        solver.setTolerance( 1.e-8 );
+        solver.setMaxIterations( 50 );
+        solver.solve(rhs,sol);
+        CHECK ( solver.error() <= solver.tolerance() );
+    }
+    else if (testcase==5)
+    {
+        typedef gsChebyshevSmootherOp<gsSparseMatrix<> > Cheb;
+        Cheb::Ptr cheb = Cheb::make(mat, 3);
+
+        // The estimate is a lower bound for the largest eigenvalue of D^{-1} A
+        const gsVector<> s = mat.diagonal().cwiseSqrt().cwiseInverse();
+        const gsMatrix<> scaled = s.asDiagonal() * mat.toDense() * s.asDiagonal();
+        const real_t lmax = gsMatrix<>::SelfAdjEigenSolver(scaled).eigenvalues().maxCoeff();
+        CHECK( cheb->maxEigenvalue() <= lmax * 1.001 );
+        CHECK( cheb->maxEigenvalue() >= lmax * 0.9 );
+
+        gsConjugateGradient<> solver(mat, cheb);
+        solver.setTolerance( 1.e-8 );
+        solver.setMaxIterations( 50 );
+        solver.solve(rhs,sol);
+        CHECK ( solver.error() <= solver.tolerance() );
+    }
 }
 
 
@@ -109,6 +147,14 @@ SUITE(gsPreconditioner_test)
     {
         runPreconditionerTest(3);
     }
+    TEST(gsMultiColorGaussSeidelPreconditioner_test)
+    {
+        runPreconditionerTest(4);
+    }
+    TEST(gsChebyshevSmoother_test)
+    {
+        runPreconditionerTest(5);
+    }
 
     TEST(gsPatchPreconditioner_stiff_test)
     {
@@ -266,5 +312,36 @@ SUITE(gsPreconditioner_test)
         }
     }
 
+    TEST(gsAdditiveOp_parallel_test)
+    {
+        // Overlapping subspaces of different sizes
+        const index_t n = 40, nSub = 7;
+        gsAdditiveOp<> a;
+        for (index_t k=0; k<nSub; ++k)
+        {
+            const index_t first = 3*k, sz = 5 + 2*k;
+            gsSparseMatrix<real_t,RowMajor> t(n,sz);
+            for (index_t i=0; i<sz; ++i)
+                t(first+i,i) = 1;
+            gsMatrix<> o(sz,sz);
+            for (index_t i=0; i<o.size(); ++i)
+                o.data()[i] = (real_t)((i*13+k) % 17) - 8;
+            a.addOperator(t, makeMatrixOp(o.moveToPtr()));
+        }
+
+        gsMatrix<> in(n,3);
+        for (index_t i=0; i<in.size(); ++i)
+            in.data()[i] = (real_t)((i*7) % 11) - 5;
+
+        gsMatrix<> res_serial, res_parallel;
+        a.apply( in, res_serial );
+        a.setParallel();
+        a.apply( in, res_parallel );
+
+        // Same order of summation, so the results coincide
+        CHECK ( res_serial.norm() > 0 );
+        CHECK ( (res_serial-res_parallel).norm() == 0 );
+    }
+
 
 }
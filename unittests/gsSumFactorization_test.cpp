@@ -0,0 +1,138 @@
+/** @file gsSumFactorization_test.cpp
+
+    @brief Tests sum-factorized assembly against the standard visitors
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo developers
+*/
+
+#include "gismo_unittest.h"
+
+SUITE(gsSumFactorization_test)
+{
+
+gsMultiPatch<real_t> deformedCube()
+{
+    gsGeometry<real_t>::uPtr g = gsNurbsCreator<real_t>::BSplineCube(2);
+    g->coefs().col(0).array() += 0.1 * g->coefs().col(1).array().square();
+    g->coefs().col(2).array() += 0.2 * g->coefs().col(0).array() * g->coefs().col(1).array();
+    return gsMultiPatch<real_t>(*g);
+}
+
+TEST(MassStiffness)
+{
+    gsMultiPatch<real_t> mp = deformedCube();
+    gsMultiBasis<real_t> mb(mp);
+    mb.setDegree(3);
+    mb.uniformRefine();
+
+    gsGenericAssembler<real_t> ga(mp, mb);
+    const gsSparseMatrix<real_t> M0 = ga.assembleMass();
+    const gsSparseMatrix<real_t> K0 = ga.assembleStiffness();
+
+    ga.options().setSwitch("SumFactorization", true);
+    const gsSparseMatrix<real_t> M1 = ga.assembleMass();
+    const gsSparseMatrix<real_t> K1 = ga.assembleStiffness();
+
+    CHECK( (M0-M1).norm() < 1e-12 * M0.norm() );
+    CHECK( (K0-K1).norm() < 1e-12 * K0.norm() );
+}
+
+TEST(VariableCoefficients)
+{
+    gsMultiPatch<real_t> mp = deformedCube();
+    gsMultiBasis<real_t> mb(mp);
+    mb.setDegree(2);
+    mb.uniformRefine();
+
+    gsFunctionExpr<real_t> f("x*y+z",3), c("1+z",3), b("1","x","0",3),
+        A("1+x^2","0.1","0","0.1","2","0","0","0","1+y",3);
+    gsBoundaryConditions<real_t> bc;
+    for (gsMultiPatch<real_t>::const_biterator bit = mp.bBegin(); bit != mp.bEnd(); ++bit)
+        bc.addCondition(*bit, condition_type::dirichlet, &f);
+
+    gsCDRAssembler<real_t> ca(mp, mb, bc, f, A, b, c);
+    ca.assemble();
+    const gsSparseMatrix<real_t> C0 = ca.matrix();
+    const gsMatrix<real_t>       r0 = ca.rhs();
+
+    // assemble() adds to the system, use a new assembler
+    gsCDRAssembler<real_t> cs(mp, mb, bc, f, A, b, c);
+    cs.options().setSwitch("SumFactorization", true);
+    cs.assemble();
+
+    CHECK( (C0-cs.matrix()).norm() < 1e-12 * C0.norm() );
+    CHECK( (r0-cs.rhs()).norm() < 1e-12 * r0.norm() );
+}
+
+TEST(WeightedQuadrature)
+{
+    // Weighted quadrature is exact for constant coefficients
+    gsMultiPatch<real_t> mp( *gsNurbsCreator<real_t>::BSplineSquare(2.0) );
+    gsMultiBasis<real_t> mb(mp);
+    mb.setDegree(4);
+    mb.uniformRefine(15);
+
+    gsGenericAssembler<real_t> ga(mp, mb);
+    const gsSparseMatrix<real_t> M0 = ga.assembleMass();
+    const gsSparseMatrix<real_t> K0 = ga.assembleStiffness();
+
+    ga.options().setSwitch("SumFactorization", true);
+    ga.options().addInt("quRule", "Quadrature rule", gsQuadrature::WeightedQuadrature);
+    const gsSparseMatrix<real_t> M1 = ga.assembleMass();
+    const gsSparseMatrix<real_t> K1 = ga.assembleStiffness();
+
+    CHECK( (M0-M1).norm() < 1e-10 * M0.norm() );
+    CHECK( (K0-K1).norm() < 1e-10 * K0.norm() );
+}
+
+TEST(WeightedQuadratureMultiPatch)
+{
+    // The rules are computed per patch and shared by the threads
+    gsMultiPatch<real_t> mp = gsNurbsCreator<real_t>::BSplineSquareGrid(2, 2, 0.5);
+    gsMultiBasis<real_t> mb(mp);
+    mb.setDegree(3);
+    mb.uniformRefine(7);
+
+    gsGenericAssembler<real_t> ga(mp, mb);
+    ga.options().setInt("ElementChunk", 3);
+    const gsSparseMatrix<real_t> K0 = ga.assembleStiffness();
+
+    ga.options().setSwitch("SumFactorization", true);
+    ga.options().addInt("quRule", "Quadrature rule", gsQuadrature::WeightedQuadrature);
+    const gsSparseMatrix<real_t> K1 = ga.assembleStiffness();
+
+    CHECK( (K0-K1).norm() < 1e-10 * K0.norm() );
+}
+
+TEST(WeightedQuadratureMassNonAffine)
+{
+    gsMultiPatch<real_t> mp( *gsNurbsCreator<real_t>::BSplineSquare(1.0) );
+    gsMatrix<real_t> & c = mp.patch(0).coefs();
+    c.col(1).array() += 0.2 * c.col(0).array().square();
+    c.col(0).array() += 0.1 * c.col(0).array() * c.col(1).array();
+    gsMultiBasis<real_t> mb(mp);
+    mb.setDegree(3);
+    mb.uniformRefine(15); // enough knot spans for reduced nodes in the interior
+
+    gsGenericAssembler<real_t> ga(mp, mb);
+    const gsSparseMatrix<real_t> M0 = ga.assembleMass();
+
+    ga.options().setSwitch("SumFactorization", true);
+    ga.options().addInt("quRule", "Quadrature rule", gsQuadrature::WeightedQuadrature);
+    const gsSparseMatrix<real_t> M1 = ga.assembleMass();
+    // Inexact on non-affine maps, but close to Gauss
+    CHECK( (M0-M1).norm() > 1e-10 * M0.norm() );
+    CHECK( (M0-M1).norm() < 1e-4  * M0.norm() );
+
+    // Not available as a plain rule (eg. for gsExprAssembler)
+    CHECK_THROW( gsQuadrature::getPtr(mb.basis(0), ga.options()), std::runtime_error );
+    CHECK_THROW( gsQuadrature::get(mb.basis(0), ga.options()), std::runtime_error );
+}
+
+}